@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define BENCH_LOG(message) std::cerr << "[!] [" << __FUNCTION__ << "] " << message << std::endl
+
+struct bench_result
+{
+   std::string group;
+   std::string name;
+   std::size_t operations;
+   double nanoseconds;
+};
+
+template <typename T>
+inline void do_not_optimize(T const &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   asm volatile("" : : "r,m"(value) : "memory");
+#else
+   static volatile const void *sink;
+   sink = &value;
+#endif
+}
+
+inline void clobber_memory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+   asm volatile("" : : : "memory");
+#endif
+}
+
+template <typename Fn>
+double time_best_of(std::size_t repetitions, Fn &&fn)
+{
+   double best = 0.0;
+
+   for (std::size_t i=0; i<repetitions; ++i)
+   {
+      auto start = std::chrono::steady_clock::now();
+      fn();
+      clobber_memory();
+      auto stop = std::chrono::steady_clock::now();
+      double elapsed = std::chrono::duration<double, std::nano>(stop - start).count();
+
+      if (i == 0 || elapsed < best)
+         best = elapsed;
+   }
+
+   return best;
+}
+
+inline std::string json_escape(const std::string &value)
+{
+   std::string result;
+
+   for (auto c : value)
+   {
+      if (c == '"' || c == '\\')
+         result.push_back('\\');
+
+      result.push_back(c);
+   }
+
+   return result;
+}
+
+inline void write_json(std::ostream &stream, const std::vector<bench_result> &results)
+{
+   stream << "{\n  \"library\": \"ptrtools\",\n";
+#if defined(__clang__)
+   stream << "  \"compiler\": \"clang " << __clang_major__ << "." << __clang_minor__ << "\",\n";
+#elif defined(__GNUC__)
+   stream << "  \"compiler\": \"gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "\",\n";
+#elif defined(_MSC_VER)
+   stream << "  \"compiler\": \"msvc " << _MSC_VER << "\",\n";
+#else
+   stream << "  \"compiler\": \"unknown\",\n";
+#endif
+   stream << "  \"cplusplus\": " << __cplusplus << ",\n";
+   stream << "  \"results\": [\n";
+
+   for (std::size_t i=0; i<results.size(); ++i)
+   {
+      auto &result = results[i];
+      double baseline = 0.0;
+
+      for (auto &other : results)
+      {
+         if (other.group == result.group)
+         {
+            baseline = other.nanoseconds;
+            break;
+         }
+      }
+
+      stream << "    {\"group\": \"" << json_escape(result.group) << "\", "
+             << "\"name\": \"" << json_escape(result.name) << "\", "
+             << "\"operations\": " << result.operations << ", "
+             << "\"total_ns\": " << result.nanoseconds << ", "
+             << "\"ns_per_op\": " << (result.operations == 0 ? 0.0 : result.nanoseconds / result.operations) << ", "
+             << "\"relative_to_baseline\": " << (baseline == 0.0 ? 0.0 : result.nanoseconds / baseline) << "}";
+
+      if (i+1 < results.size())
+         stream << ",";
+
+      stream << "\n";
+   }
+
+   stream << "  ]\n}\n";
+}
+
+#define BENCH_INIT() \
+   std::vector<bench_result> results\
+
+#define BENCHMARK(group, name, operations, repetitions, body) \
+   do { \
+      double elapsed = time_best_of((repetitions), [&]() body); \
+      results.push_back(bench_result{(group), (name), (operations), elapsed}); \
+      BENCH_LOG((group) << " / " << (name) << ": " << elapsed / (operations) << " ns/op"); \
+   } while (0)\
+
+#define BENCH_COMPLETE(path) \
+   if ((path) == nullptr) \
+      write_json(std::cout, results); \
+   else { \
+      std::ofstream output((path)); \
+      write_json(output, results); \
+   } \
+   return 0
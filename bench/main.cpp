@@ -0,0 +1,1212 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#if __cplusplus > 201703L && __has_include(<span>)
+#include <span>
+#define PTRTOOLS_BENCH_SPAN
+#endif
+
+#include <framework.hpp>
+#include <ptrtools.hpp>
+
+using namespace ptrtools;
+
+static const std::size_t ELEMENTS = 1 << 20;
+static const std::size_t FLEXIBLE_ELEMENTS = 1 << 14;
+static const std::size_t REPETITIONS = 7;
+
+struct bench_record
+{
+   std::uint64_t id;
+   double price;
+   std::uint32_t quantity;
+   std::uint8_t padding[44];
+};
+
+struct bench_flexible
+{
+   std::uint32_t count;
+   std::uint32_t flags;
+   std::uint32_t entries[1];
+};
+
+// writes one byte per page so the allocation is actually faulted in and cannot be elided
+void touch_pages(std::uint8_t *buffer, std::size_t size)
+{
+   for (std::size_t i=0; i<size; i+=4096)
+      buffer[i] = static_cast<std::uint8_t>(i);
+
+   do_not_optimize(buffer);
+   clobber_memory();
+}
+
+void bench_access(std::vector<bench_result> &results)
+{
+   std::vector<std::uint32_t> vector(ELEMENTS);
+   std::iota(vector.begin(), vector.end(), 0);
+
+   const std::uint32_t *raw = vector.data();
+   basic_ptr<std::uint32_t> basic(vector.data(), ELEMENTS*sizeof(std::uint32_t));
+   array_ptr<std::uint32_t> array(vector.data(), ELEMENTS);
+   array_ptr<std::uint32_t,std::allocator<std::uint8_t>,debug_policy> debug_array(vector.data(), ELEMENTS);
+   array_ptr<std::uint32_t,std::allocator<std::uint8_t>,unchecked_policy> unchecked_array(vector.data(), ELEMENTS);
+#ifdef PTRTOOLS_BENCH_SPAN
+   std::span<const std::uint32_t> span(vector.data(), vector.size());
+#endif
+
+   BENCHMARK("access", "raw pointer", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += raw[i];
+      do_not_optimize(sum);
+   });
+   BENCHMARK("access", "std::vector::operator[]", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += vector[i];
+      do_not_optimize(sum);
+   });
+#ifdef PTRTOOLS_BENCH_SPAN
+   BENCHMARK("access", "std::span::operator[]", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += span[i];
+      do_not_optimize(sum);
+   });
+#endif
+   BENCHMARK("access", "basic_ptr::at", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += basic.at(i);
+      do_not_optimize(sum);
+   });
+   BENCHMARK("access", "basic_ptr::operator[]", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += basic[i];
+      do_not_optimize(sum);
+   });
+   BENCHMARK("access", "basic_ptr::handle_at", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += *basic.handle_at(i*sizeof(std::uint32_t));
+      do_not_optimize(sum);
+   });
+   BENCHMARK("access", "array_ptr::operator[]", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += array[i];
+      do_not_optimize(sum);
+   });
+   BENCHMARK("access", "array_ptr::operator[] (debug_policy)", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += debug_array[i];
+      do_not_optimize(sum);
+   });
+   BENCHMARK("access", "array_ptr::operator[] (unchecked_policy)", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<ELEMENTS; ++i) sum += unchecked_array[i];
+      do_not_optimize(sum);
+   });
+
+   // byte stores may alias the pointer's own members, so anything left on the mutable access
+   // path cannot be hoisted out of the loop
+   using unchecked_bytes = array_ptr<std::uint8_t,std::allocator<std::uint8_t>,unchecked_policy>;
+   using shared_bytes = array_ptr<std::uint8_t,std::allocator<std::uint8_t>,copy_on_write_policy<unchecked_policy>>;
+
+   std::vector<std::uint8_t> bytes(ELEMENTS);
+   std::uint8_t *raw_bytes = bytes.data();
+   unchecked_bytes unchecked_byte_array(bytes.data(), ELEMENTS);
+   shared_bytes shared_byte_array(ELEMENTS);
+
+   BENCHMARK("byte increment", "raw pointer", ELEMENTS, REPETITIONS, {
+      for (std::size_t i=0; i<ELEMENTS; ++i) raw_bytes[i] += 1;
+      clobber_memory();
+   });
+   BENCHMARK("byte increment", "array_ptr::operator[] (unchecked_policy)", ELEMENTS, REPETITIONS, {
+      for (std::size_t i=0; i<ELEMENTS; ++i) unchecked_byte_array[i] += 1;
+      clobber_memory();
+   });
+   BENCHMARK("byte increment", "array_ptr::operator[] (copy_on_write_policy<unchecked_policy>)", ELEMENTS, REPETITIONS, {
+      for (std::size_t i=0; i<ELEMENTS; ++i) shared_byte_array[i] += 1;
+      clobber_memory();
+   });
+}
+
+void bench_iterators(std::vector<bench_result> &results)
+{
+   std::vector<std::uint32_t> vector(ELEMENTS);
+   std::iota(vector.begin(), vector.end(), 0);
+
+   std::uint32_t *raw = vector.data();
+   array_ptr<std::uint32_t> array(vector.data(), ELEMENTS);
+   const array_ptr<std::uint32_t> const_array(vector.data(), ELEMENTS);
+   array_ptr<std::uint32_t,std::allocator<std::uint8_t>,unchecked_policy> unchecked_array(vector.data(), ELEMENTS);
+#ifdef PTRTOOLS_BENCH_SPAN
+   std::span<std::uint32_t> span(vector.data(), vector.size());
+#endif
+
+   BENCHMARK("forward iteration", "raw pointer", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=raw; iter!=raw+ELEMENTS; ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+   BENCHMARK("forward iteration", "std::vector::iterator", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=vector.begin(); iter!=vector.end(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+#ifdef PTRTOOLS_BENCH_SPAN
+   BENCHMARK("forward iteration", "std::span::iterator", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=span.begin(); iter!=span.end(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+#endif
+   BENCHMARK("forward iteration", "basic_ptr::iterator", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=array.begin(); iter!=array.end(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+   BENCHMARK("forward iteration", "basic_ptr::const_iterator", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=const_array.cbegin(); iter!=const_array.cend(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+   BENCHMARK("forward iteration", "basic_ptr::iterator (unchecked_policy)", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=unchecked_array.begin(); iter!=unchecked_array.end(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+
+   BENCHMARK("reverse iteration", "raw pointer", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=raw+ELEMENTS; iter!=raw; --iter) sum += *(iter-1);
+      do_not_optimize(sum);
+   });
+   BENCHMARK("reverse iteration", "std::vector::reverse_iterator", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=vector.rbegin(); iter!=vector.rend(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+#ifdef PTRTOOLS_BENCH_SPAN
+   BENCHMARK("reverse iteration", "std::span::reverse_iterator", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=span.rbegin(); iter!=span.rend(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+#endif
+   BENCHMARK("reverse iteration", "basic_ptr::reverse_iterator", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=array.rbegin(); iter!=array.rend(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+   BENCHMARK("reverse iteration", "basic_ptr::const_reverse_iterator", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto iter=const_array.crbegin(); iter!=const_array.crend(); ++iter) sum += *iter;
+      do_not_optimize(sum);
+   });
+}
+
+void bench_sort(std::vector<bench_result> &results)
+{
+   const std::size_t SORT_ELEMENTS = 1 << 16;
+   std::vector<std::uint32_t> source(SORT_ELEMENTS);
+   std::uint32_t state = 0x8675309;
+
+   for (auto &value : source)
+   {
+      state = state * 1664525 + 1013904223;
+      value = state;
+   }
+
+   std::vector<std::uint32_t> vector(SORT_ELEMENTS);
+   array_ptr<std::uint32_t> array(vector.data(), SORT_ELEMENTS);
+   auto raw = vector.data();
+
+   BENCHMARK("sort", "raw pointer", SORT_ELEMENTS, REPETITIONS, {
+      std::copy(source.begin(), source.end(), raw);
+      std::sort(raw, raw+SORT_ELEMENTS);
+      do_not_optimize(raw[0]);
+   });
+   BENCHMARK("sort", "std::vector::iterator", SORT_ELEMENTS, REPETITIONS, {
+      std::copy(source.begin(), source.end(), vector.begin());
+      std::sort(vector.begin(), vector.end());
+      do_not_optimize(vector[0]);
+   });
+   BENCHMARK("sort", "basic_ptr::iterator", SORT_ELEMENTS, REPETITIONS, {
+      std::copy(source.begin(), source.end(), array.begin());
+      std::sort(array.begin(), array.end());
+      do_not_optimize(array[0]);
+   });
+   BENCHMARK("lower_bound", "raw pointer", SORT_ELEMENTS, REPETITIONS, {
+      std::size_t hits = 0;
+      for (std::size_t i=0; i<SORT_ELEMENTS; ++i) hits += *std::lower_bound(raw, raw+SORT_ELEMENTS, source[i]) == source[i];
+      do_not_optimize(hits);
+   });
+   BENCHMARK("lower_bound", "basic_ptr::iterator", SORT_ELEMENTS, REPETITIONS, {
+      std::size_t hits = 0;
+      for (std::size_t i=0; i<SORT_ELEMENTS; ++i) hits += *std::lower_bound(array.begin(), array.end(), source[i]) == source[i];
+      do_not_optimize(hits);
+   });
+}
+
+void bench_flexible_access(std::vector<bench_result> &results)
+{
+   flexible_ptr<bench_flexible,std::uint32_t> flexible(FLEXIBLE_ELEMENTS);
+   auto raw = flexible.get()->entries;
+   std::vector<std::uint32_t> vector(FLEXIBLE_ELEMENTS);
+
+   for (std::size_t i=0; i<FLEXIBLE_ELEMENTS; ++i)
+      raw[i] = vector[i] = static_cast<std::uint32_t>(i);
+
+#ifdef PTRTOOLS_BENCH_SPAN
+   std::span<const std::uint32_t> span(raw, FLEXIBLE_ELEMENTS);
+#endif
+
+   BENCHMARK("flexible access", "raw pointer", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<FLEXIBLE_ELEMENTS; ++i) sum += raw[i];
+      do_not_optimize(sum);
+   });
+   BENCHMARK("flexible access", "std::vector::operator[]", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<FLEXIBLE_ELEMENTS; ++i) sum += vector[i];
+      do_not_optimize(sum);
+   });
+#ifdef PTRTOOLS_BENCH_SPAN
+   BENCHMARK("flexible access", "std::span::operator[]", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<FLEXIBLE_ELEMENTS; ++i) sum += span[i];
+      do_not_optimize(sum);
+   });
+#endif
+   BENCHMARK("flexible access", "flexible_ptr::operator[]", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (std::size_t i=0; i<FLEXIBLE_ELEMENTS; ++i) sum += flexible[i];
+      do_not_optimize(sum);
+   });
+   BENCHMARK("flexible access", "flexible_ptr::flexible_array()[]", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      auto entries = flexible.flexible_array();
+      for (std::size_t i=0; i<FLEXIBLE_ELEMENTS; ++i) sum += entries[i];
+      do_not_optimize(sum);
+   });
+   BENCHMARK("flexible access", "flexible_ptr::iterator", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto entry : flexible) sum += entry;
+      do_not_optimize(sum);
+   });
+
+   using growing_flexible = flexible_ptr<bench_flexible,std::uint32_t>;
+
+   BENCHMARK("flexible growth", "std::vector::push_back", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      std::vector<std::uint32_t> grown;
+      for (std::size_t i=0; i<FLEXIBLE_ELEMENTS; ++i) grown.push_back(static_cast<std::uint32_t>(i));
+      do_not_optimize(grown);
+   });
+   BENCHMARK("flexible growth", "flexible_ptr::reallocate(elements()+1)", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      growing_flexible grown(1);
+      for (std::size_t i=1; i<FLEXIBLE_ELEMENTS; ++i)
+      {
+         grown.reallocate(grown.elements() + 1);
+         grown[i] = static_cast<std::uint32_t>(i);
+      }
+      do_not_optimize(grown);
+   });
+   BENCHMARK("flexible growth", "flexible_ptr::push_back", FLEXIBLE_ELEMENTS, REPETITIONS, {
+      growing_flexible grown(1);
+      for (std::size_t i=1; i<FLEXIBLE_ELEMENTS; ++i) grown.push_back(static_cast<std::uint32_t>(i));
+      do_not_optimize(grown);
+   });
+}
+
+void bench_memory(std::vector<bench_result> &results)
+{
+   std::vector<std::uint32_t> source(ELEMENTS);
+   std::iota(source.begin(), source.end(), 0);
+
+   const std::size_t bytes = ELEMENTS*sizeof(std::uint32_t);
+
+   BENCHMARK("clone", "raw pointer (new + memcpy)", ELEMENTS, REPETITIONS, {
+      auto buffer = new std::uint32_t[ELEMENTS];
+      std::memcpy(buffer, source.data(), bytes);
+      do_not_optimize(buffer);
+      delete[] buffer;
+   });
+   BENCHMARK("clone", "std::vector copy", ELEMENTS, REPETITIONS, {
+      std::vector<std::uint32_t> copy(source);
+      do_not_optimize(copy.data());
+   });
+   BENCHMARK("clone", "array_ptr::clone", ELEMENTS, REPETITIONS, {
+      array_ptr<std::uint32_t> clone;
+      clone.clone(source.data(), ELEMENTS);
+      do_not_optimize(clone.get());
+   });
+
+   const std::size_t LARGE_BYTES = 64 << 20;
+
+   BENCHMARK("allocate", "raw pointer (calloc)", LARGE_BYTES, 3, {
+      auto buffer = static_cast<std::uint8_t *>(std::calloc(1, LARGE_BYTES));
+      touch_pages(buffer, LARGE_BYTES);
+      std::free(buffer);
+   });
+   BENCHMARK("allocate", "raw pointer (malloc + memset)", LARGE_BYTES, 3, {
+      auto buffer = static_cast<std::uint8_t *>(std::malloc(LARGE_BYTES));
+      std::memset(buffer, 0, LARGE_BYTES);
+      touch_pages(buffer, LARGE_BYTES);
+      std::free(buffer);
+   });
+   BENCHMARK("allocate", "std::vector", LARGE_BYTES, 3, {
+      std::vector<std::uint8_t> vector(LARGE_BYTES);
+      touch_pages(vector.data(), LARGE_BYTES);
+   });
+   BENCHMARK("allocate", "array_ptr (zeroed)", LARGE_BYTES, 3, {
+      array_ptr<std::uint8_t> array(LARGE_BYTES, allocation_mode::zeroed);
+      touch_pages(array.get(), LARGE_BYTES);
+   });
+   BENCHMARK("allocate", "array_ptr (uninitialized)", LARGE_BYTES, 3, {
+      array_ptr<std::uint8_t> array(LARGE_BYTES, allocation_mode::uninitialized);
+      touch_pages(array.get(), LARGE_BYTES);
+   });
+   BENCHMARK("allocate", "array_ptr (lazily_zeroed)", LARGE_BYTES, 3, {
+      array_ptr<std::uint8_t> array(LARGE_BYTES, allocation_mode::lazily_zeroed);
+      touch_pages(array.get(), LARGE_BYTES);
+   });
+
+   std::vector<std::uint32_t> vector_target(ELEMENTS);
+   array_ptr<std::uint32_t> array_target(ELEMENTS);
+   auto raw_target = vector_target.data();
+
+   BENCHMARK("copy", "raw pointer (memcpy)", ELEMENTS, REPETITIONS, {
+      std::memcpy(raw_target, source.data(), bytes);
+      do_not_optimize(raw_target);
+   });
+   BENCHMARK("copy", "std::copy into std::vector", ELEMENTS, REPETITIONS, {
+      std::copy(source.begin(), source.end(), vector_target.begin());
+      do_not_optimize(vector_target.data());
+   });
+   BENCHMARK("copy", "array_ptr::copy", ELEMENTS, REPETITIONS, {
+      array_target.copy(source.data(), ELEMENTS);
+      do_not_optimize(array_target.get());
+   });
+
+   const std::size_t GROWTH_STEPS = 4096;
+
+   BENCHMARK("reallocate", "raw pointer (realloc)", GROWTH_STEPS, REPETITIONS, {
+      void *buffer = nullptr;
+      for (std::size_t i=1; i<=GROWTH_STEPS; ++i)
+      {
+         buffer = std::realloc(buffer, i*sizeof(std::uint32_t));
+         static_cast<std::uint32_t *>(buffer)[i-1] = static_cast<std::uint32_t>(i);
+      }
+      do_not_optimize(buffer);
+      std::free(buffer);
+   });
+   BENCHMARK("reallocate", "std::vector::push_back", GROWTH_STEPS, REPETITIONS, {
+      std::vector<std::uint32_t> vector;
+      for (std::size_t i=1; i<=GROWTH_STEPS; ++i)
+         vector.push_back(static_cast<std::uint32_t>(i));
+      do_not_optimize(vector.data());
+   });
+   BENCHMARK("reallocate", "array_ptr::reallocate", GROWTH_STEPS, REPETITIONS, {
+      array_ptr<std::uint32_t> array;
+      for (std::size_t i=1; i<=GROWTH_STEPS; ++i)
+      {
+         array.reallocate(i);
+         array[i-1] = static_cast<std::uint32_t>(i);
+      }
+      do_not_optimize(array.get());
+   });
+   BENCHMARK("reallocate", "array_ptr::push_back", GROWTH_STEPS, REPETITIONS, {
+      array_ptr<std::uint32_t> array;
+      for (std::size_t i=1; i<=GROWTH_STEPS; ++i)
+         array.push_back(static_cast<std::uint32_t>(i));
+      do_not_optimize(array.get());
+   });
+}
+
+void bench_construction(std::vector<bench_result> &results)
+{
+   const std::size_t SMALL_ELEMENTS = 16;
+   const std::size_t CONSTRUCTIONS = 1 << 16;
+
+   std::vector<std::uint32_t> vector_source(SMALL_ELEMENTS);
+   array_ptr<std::uint32_t> owned_source(SMALL_ELEMENTS);
+   array_ptr<std::uint32_t> borrowed_source(vector_source.data(), SMALL_ELEMENTS);
+   std::uint32_t *raw_source = vector_source.data();
+
+   BENCHMARK("copy construction", "raw pointer", CONSTRUCTIONS, REPETITIONS, {
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         std::uint32_t *copy = raw_source;
+         do_not_optimize(copy);
+      }
+   });
+   BENCHMARK("copy construction", "std::vector", CONSTRUCTIONS, REPETITIONS, {
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         std::vector<std::uint32_t> copy(vector_source);
+         do_not_optimize(copy.data());
+      }
+   });
+#ifdef PTRTOOLS_BENCH_SPAN
+   BENCHMARK("copy construction", "std::span", CONSTRUCTIONS, REPETITIONS, {
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         std::span<std::uint32_t> copy(raw_source, SMALL_ELEMENTS);
+         do_not_optimize(copy.data());
+      }
+   });
+#endif
+   BENCHMARK("copy construction", "array_ptr (borrowed)", CONSTRUCTIONS, REPETITIONS, {
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         array_ptr<std::uint32_t> copy(borrowed_source);
+         do_not_optimize(copy.get());
+      }
+   });
+   BENCHMARK("copy construction", "array_view", CONSTRUCTIONS, REPETITIONS, {
+      auto view = borrowed_source.view();
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         array_view<std::uint32_t> copy(view);
+         do_not_optimize(copy.get());
+      }
+   });
+   BENCHMARK("copy construction", "array_ptr (allocated)", CONSTRUCTIONS, REPETITIONS, {
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         array_ptr<std::uint32_t> copy(owned_source);
+         do_not_optimize(copy.get());
+      }
+   });
+
+   BENCHMARK("move construction", "raw pointer", CONSTRUCTIONS, REPETITIONS, {
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         std::uint32_t *moved = std::move(raw_source);
+         do_not_optimize(moved);
+      }
+   });
+   BENCHMARK("move construction", "std::vector", CONSTRUCTIONS, REPETITIONS, {
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         std::vector<std::uint32_t> source(SMALL_ELEMENTS);
+         std::vector<std::uint32_t> moved(std::move(source));
+         do_not_optimize(moved.data());
+      }
+   });
+   BENCHMARK("move construction", "array_ptr", CONSTRUCTIONS, REPETITIONS, {
+      for (std::size_t i=0; i<CONSTRUCTIONS; ++i)
+      {
+         array_ptr<std::uint32_t> source(SMALL_ELEMENTS);
+         array_ptr<std::uint32_t> moved(std::move(source));
+         do_not_optimize(moved.get());
+      }
+   });
+}
+
+// every thread clones a struct and rebuilds a small flexible structure in a tight loop, the
+// allocation pattern of a parsing worker
+template <typename Allocator>
+void churn_threads(std::size_t threads, std::size_t iterations)
+{
+   std::vector<std::thread> workers;
+
+   for (std::size_t t=0; t<threads; ++t)
+      workers.emplace_back([iterations]() {
+         struct_ptr<bench_flexible,Allocator> source(true);
+
+         for (std::size_t i=0; i<iterations; ++i)
+         {
+            struct_ptr<bench_flexible,Allocator> cloned(source);
+            flexible_ptr<bench_flexible,std::uint32_t,1,Allocator> entries(1 + i % 16);
+
+            do_not_optimize(cloned.get());
+            do_not_optimize(entries.get());
+         }
+      });
+
+   for (auto &worker : workers)
+      worker.join();
+}
+
+void bench_allocators(std::vector<bench_result> &results)
+{
+   const std::size_t OBJECTS = 1 << 14;
+   std::vector<struct_ptr<bench_flexible>> heap_objects;
+   std::vector<struct_ptr<bench_flexible,arena_allocator<>>> arena_objects;
+   std::vector<pmr::struct_ptr<bench_flexible>> pmr_objects;
+
+   heap_objects.reserve(OBJECTS);
+   arena_objects.reserve(OBJECTS);
+   pmr_objects.reserve(OBJECTS);
+
+   arena region(OBJECTS * 2 * sizeof(std::max_align_t));
+   arena_allocator<> arena_alloc(region);
+
+   BENCHMARK("per-request allocation", "std::allocator", OBJECTS, REPETITIONS, {
+      for (std::size_t i=0; i<OBJECTS; ++i)
+         heap_objects.emplace_back(true);
+
+      do_not_optimize(heap_objects.back().get());
+      heap_objects.clear();
+   });
+   BENCHMARK("per-request allocation", "arena_allocator", OBJECTS, REPETITIONS, {
+      for (std::size_t i=0; i<OBJECTS; ++i)
+         arena_objects.emplace_back(arena_alloc, true);
+
+      do_not_optimize(arena_objects.back().get());
+      arena_objects.clear();
+      region.reset();
+   });
+   BENCHMARK("per-request allocation", "pmr::monotonic_buffer_resource", OBJECTS, REPETITIONS, {
+      std::pmr::monotonic_buffer_resource resource(OBJECTS * 2 * sizeof(std::max_align_t));
+
+      for (std::size_t i=0; i<OBJECTS; ++i)
+         pmr_objects.emplace_back(pmr::allocator(&resource), true);
+
+      do_not_optimize(pmr_objects.back().get());
+      pmr_objects.clear();
+   });
+
+   const std::size_t CHURN_ITERATIONS = 1 << 16;
+   const std::size_t CHURN_THREADS = std::max<std::size_t>(4, std::thread::hardware_concurrency());
+   const std::size_t CHURN_OPERATIONS = CHURN_ITERATIONS * CHURN_THREADS * 2;
+
+   BENCHMARK("multithreaded churn", "std::allocator", CHURN_OPERATIONS, REPETITIONS, {
+      churn_threads<std::allocator<std::uint8_t>>(CHURN_THREADS, CHURN_ITERATIONS);
+   });
+   BENCHMARK("multithreaded churn", "caching_allocator", CHURN_OPERATIONS, REPETITIONS, {
+      churn_threads<caching_allocator<>>(CHURN_THREADS, CHURN_ITERATIONS);
+   });
+}
+
+void bench_mapped(std::vector<bench_result> &results)
+{
+#ifdef PTRTOOLS_HAS_MMAP
+   const std::size_t FILE_SIZE = 64 * 1024 * 1024;
+   const std::size_t OPENS = 8;
+   auto path = (std::filesystem::temp_directory_path() / "ptrtools_bench_mapped.bin").string();
+
+   {
+      array_ptr<std::uint8_t> contents(FILE_SIZE);
+      std::ofstream output(path, std::ios::binary | std::ios::trunc);
+      output.write(reinterpret_cast<const char *>(contents.get()), FILE_SIZE);
+   }
+
+   BENCHMARK("open and read header", "read into clone", OPENS, REPETITIONS, {
+      for (std::size_t i=0; i<OPENS; ++i)
+      {
+         std::ifstream input(path, std::ios::binary);
+         array_ptr<std::uint8_t> buffer(FILE_SIZE, allocation_mode::uninitialized);
+         input.read(reinterpret_cast<char *>(buffer.get()), FILE_SIZE);
+         const struct_ptr<bench_flexible> header(reinterpret_cast<const bench_flexible *>(buffer.get()));
+         do_not_optimize(header->count);
+      }
+   });
+   BENCHMARK("open and read header", "mapped_file", OPENS, REPETITIONS, {
+      for (std::size_t i=0; i<OPENS; ++i)
+      {
+         mapped_file file(path);
+         const auto header = file.struct_at<bench_flexible>();
+         do_not_optimize(header->count);
+      }
+   });
+
+   std::filesystem::remove(path);
+#endif
+}
+
+template <typename Allocator>
+std::uint64_t random_gather(array_ptr<std::uint64_t,Allocator,unchecked_policy> &table, std::size_t lookups)
+{
+   std::uint64_t state = 0x9E3779B97F4A7C15ULL, sum = 0;
+   auto mask = table.elements() - 1;
+
+   for (std::size_t i=0; i<lookups; ++i)
+   {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      sum += table[state & mask];
+   }
+
+   return sum;
+}
+
+void bench_alignment(std::vector<bench_result> &results)
+{
+   const std::size_t TABLE_ELEMENTS = (256 * 1024 * 1024) / sizeof(std::uint64_t);
+   const std::size_t LOOKUPS = 1 << 22;
+
+   {
+      array_ptr<std::uint64_t,std::allocator<std::uint8_t>,unchecked_policy> table(TABLE_ELEMENTS, allocation_mode::uninitialized);
+      std::iota(table.begin(), table.end(), 0);
+
+      BENCHMARK("random lookups in 256 MiB", "std::allocator", LOOKUPS, REPETITIONS, {
+         do_not_optimize(random_gather(table, LOOKUPS));
+      });
+   }
+   {
+      array_ptr<std::uint64_t,huge_page_allocator<>,unchecked_policy> table(TABLE_ELEMENTS, allocation_mode::uninitialized);
+      std::iota(table.begin(), table.end(), 0);
+
+      BENCHMARK("random lookups in 256 MiB", "huge_page_allocator", LOOKUPS, REPETITIONS, {
+         do_not_optimize(random_gather(table, LOOKUPS));
+      });
+   }
+}
+
+void bench_simd(std::vector<bench_result> &results)
+{
+   const simd::level levels[] = { simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512 };
+   const char *level_names[] = { "array_ptr (scalar)", "array_ptr (sse2)", "array_ptr (avx2)", "array_ptr (avx512)" };
+   auto supported = simd::supported_level();
+
+   array_ptr<std::uint32_t> data(ELEMENTS);
+   array_ptr<std::uint32_t> other(ELEMENTS);
+
+   for (std::size_t i=0; i<ELEMENTS; ++i)
+      data[i] = static_cast<std::uint32_t>((i * 2654435761u) >> 8);
+
+   other.copy(data);
+
+   const std::uint32_t *raw = data.get();
+   const std::uint32_t needle = data[ELEMENTS - 1];
+
+   BENCHMARK("find", "std::find", ELEMENTS, REPETITIONS, {
+      do_not_optimize(std::find(raw, raw + ELEMENTS, needle));
+   });
+   BENCHMARK("count", "std::count", ELEMENTS, REPETITIONS, {
+      do_not_optimize(std::count(raw, raw + ELEMENTS, needle));
+   });
+   BENCHMARK("min", "std::min_element", ELEMENTS, REPETITIONS, {
+      do_not_optimize(*std::min_element(raw, raw + ELEMENTS));
+   });
+   BENCHMARK("equal", "std::equal", ELEMENTS, REPETITIONS, {
+      do_not_optimize(std::equal(raw, raw + ELEMENTS, other.get()));
+   });
+   BENCHMARK("fill", "std::fill", ELEMENTS, REPETITIONS, {
+      std::fill(other.get(), other.get() + ELEMENTS, 0x69u);
+      clobber_memory();
+   });
+
+   for (std::size_t i=0; i<4; ++i)
+   {
+      if (static_cast<int>(levels[i]) > static_cast<int>(supported))
+         break;
+
+      simd::set_level(levels[i]);
+      other.copy(data);
+
+      BENCHMARK("find", level_names[i], ELEMENTS, REPETITIONS, {
+         do_not_optimize(data.find(needle));
+      });
+      BENCHMARK("count", level_names[i], ELEMENTS, REPETITIONS, {
+         do_not_optimize(data.count(needle));
+      });
+      BENCHMARK("min", level_names[i], ELEMENTS, REPETITIONS, {
+         do_not_optimize(data.min());
+      });
+      BENCHMARK("equal", level_names[i], ELEMENTS, REPETITIONS, {
+         do_not_optimize(data.equal(other));
+      });
+      BENCHMARK("fill", level_names[i], ELEMENTS, REPETITIONS, {
+         other.fill(0x69u);
+         clobber_memory();
+      });
+   }
+
+   simd::set_level(supported);
+}
+
+void bench_search(std::vector<bench_result> &results)
+{
+   const simd::level levels[] = { simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512 };
+   const char *level_names[] = { "basic_ptr (scalar)", "basic_ptr (sse2)", "basic_ptr (avx2)", "basic_ptr (avx512)" };
+   auto supported = simd::supported_level();
+
+   // text-like input: every byte is a likely first byte of the pattern, so memchr alone stalls often
+   basic_ptr<std::uint8_t> text(ELEMENTS);
+   std::uint32_t seed = 42;
+
+   for (std::size_t i=0; i<ELEMENTS; ++i)
+   {
+      seed = seed * 1103515245 + 12345;
+      text[i] = static_cast<std::uint8_t>('a' + (seed >> 16) % 16);
+   }
+
+   const std::string_view needle = "ponmlkjihgfe";
+   const std::string_view needles[] = { "ponmlk", "qrstu", "zzzz", "xyz", "onm!", "lkji?", "mnop." };
+   byte_patterns patterns(needles);
+   std::string_view haystack(reinterpret_cast<const char *>(text.get()), text.size());
+
+   BENCHMARK("find pattern", "std::string_view::find", ELEMENTS, REPETITIONS, {
+      do_not_optimize(haystack.find(needle));
+   });
+   BENCHMARK("find pattern", "std::boyer_moore_horspool_searcher", ELEMENTS, REPETITIONS, {
+      do_not_optimize(std::search(haystack.begin(), haystack.end(), std::boyer_moore_horspool_searcher(needle.begin(), needle.end())));
+   });
+#ifdef __GLIBC__
+   BENCHMARK("find pattern", "memmem", ELEMENTS, REPETITIONS, {
+      do_not_optimize(memmem(haystack.data(), haystack.size(), needle.data(), needle.size()));
+   });
+#endif
+   BENCHMARK("find any of 7 patterns", "std::string_view::find per pattern", ELEMENTS, REPETITIONS, {
+      auto best = std::string_view::npos;
+
+      for (auto pattern : needles)
+         best = std::min(best, haystack.find(pattern));
+
+      do_not_optimize(best);
+   });
+
+   for (std::size_t i=0; i<4; ++i)
+   {
+      if (static_cast<int>(levels[i]) > static_cast<int>(supported))
+         break;
+
+      simd::set_level(levels[i]);
+
+      BENCHMARK("find pattern", level_names[i], ELEMENTS, REPETITIONS, {
+         do_not_optimize(text.find_bytes(needle));
+      });
+      BENCHMARK("find any of 7 patterns", level_names[i], ELEMENTS, REPETITIONS, {
+         do_not_optimize(text.find_any(patterns).offset);
+      });
+   }
+
+   simd::set_level(supported);
+}
+
+void bench_endian(std::vector<bench_result> &results)
+{
+   const simd::level levels[] = { simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512 };
+   const char *level_names[] = { "array_ptr::byteswap (scalar)", "array_ptr::byteswap (sse2)", "array_ptr::byteswap (avx2)", "array_ptr::byteswap (avx512)" };
+   auto supported = simd::supported_level();
+
+   array_ptr<std::uint32_t> data(ELEMENTS);
+   std::iota(data.get(), data.get() + ELEMENTS, 0u);
+
+   std::uint32_t *raw = data.get();
+   auto fields = reinterpret_cast<be<std::uint32_t> *>(raw);
+
+   BENCHMARK("byteswap", "raw pointer + __builtin_bswap32", ELEMENTS, REPETITIONS, {
+      for (std::size_t i=0; i<ELEMENTS; ++i)
+         raw[i] = __builtin_bswap32(raw[i]);
+
+      clobber_memory();
+   });
+   BENCHMARK("byteswap", "be<std::uint32_t> reads", ELEMENTS, REPETITIONS, {
+      std::uint32_t sum = 0;
+
+      for (std::size_t i=0; i<ELEMENTS; ++i)
+         sum += fields[i];
+
+      do_not_optimize(sum);
+   });
+
+   for (std::size_t i=0; i<4; ++i)
+   {
+      if (static_cast<int>(levels[i]) > static_cast<int>(supported))
+         break;
+
+      simd::set_level(levels[i]);
+
+      BENCHMARK("byteswap", level_names[i], ELEMENTS, REPETITIONS, {
+         data.byteswap();
+         clobber_memory();
+      });
+   }
+
+   simd::set_level(supported);
+}
+
+void bench_parallel(std::vector<bench_result> &results)
+{
+   array_ptr<std::uint32_t> data(ELEMENTS * 8);
+   array_ptr<std::uint32_t> other(ELEMENTS * 8);
+   auto elements = data.elements();
+
+   // fault the pages in first so the baseline does not pay for them
+   std::memset(data.get(), 1, data.size());
+   std::memset(other.get(), 1, other.size());
+
+   BENCHMARK("fill 32 MiB", "std::fill", elements, REPETITIONS, {
+      std::fill(data.get(), data.get() + elements, 0x69u);
+      clobber_memory();
+   });
+   BENCHMARK("fill 32 MiB", "parallel::fill", elements, REPETITIONS, {
+      parallel::fill(data, 0x69u);
+      clobber_memory();
+   });
+   BENCHMARK("copy 32 MiB", "std::memcpy", elements, REPETITIONS, {
+      std::memcpy(other.get(), data.get(), data.size());
+      clobber_memory();
+   });
+   BENCHMARK("copy 32 MiB", "parallel::copy", elements, REPETITIONS, {
+      parallel::copy(data, other);
+      clobber_memory();
+   });
+   BENCHMARK("reduce 32 MiB", "std::accumulate", elements, REPETITIONS, {
+      do_not_optimize(std::accumulate(data.get(), data.get() + elements, std::uint64_t(0)));
+   });
+   BENCHMARK("reduce 32 MiB", "parallel::reduce", elements, REPETITIONS, {
+      do_not_optimize(parallel::reduce(data, std::uint64_t(0)));
+   });
+}
+
+void bench_strided(std::vector<bench_result> &results)
+{
+   array_ptr<bench_record> records(ELEMENTS);
+   array_ptr<double> prices(ELEMENTS);
+
+   for (std::size_t i=0; i<ELEMENTS; ++i)
+      records[i].price = static_cast<double>(i % 1000);
+
+   const bench_record *raw = records.get();
+   auto price_view = records.field(&bench_record::price);
+
+   BENCHMARK("sum one field of 64-byte records", "raw pointer loop", ELEMENTS, REPETITIONS, {
+      double sum = 0;
+
+      for (std::size_t i=0; i<ELEMENTS; ++i)
+         sum += raw[i].price;
+
+      do_not_optimize(sum);
+   });
+   BENCHMARK("sum one field of 64-byte records", "array_ptr::iterator", ELEMENTS, REPETITIONS, {
+      double sum = 0;
+
+      for (auto &record : records)
+         sum += record.price;
+
+      do_not_optimize(sum);
+   });
+   BENCHMARK("sum one field of 64-byte records", "strided_view::sum", ELEMENTS, REPETITIONS, {
+      do_not_optimize(price_view.sum());
+   });
+   BENCHMARK("gather one field of 64-byte records", "raw pointer loop", ELEMENTS, REPETITIONS, {
+      for (std::size_t i=0; i<ELEMENTS; ++i)
+         prices.get()[i] = raw[i].price;
+
+      clobber_memory();
+   });
+   BENCHMARK("gather one field of 64-byte records", "strided_view::gather_to", ELEMENTS, REPETITIONS, {
+      price_view.gather_to(prices);
+      clobber_memory();
+   });
+}
+
+void bench_soa(std::vector<bench_result> &results)
+{
+   array_ptr<bench_record> records(ELEMENTS);
+
+   for (std::size_t i=0; i<ELEMENTS; ++i)
+   {
+      records[i].id = i;
+      records[i].price = static_cast<double>(i % 1000);
+   }
+
+   const bench_record *raw = records.get();
+   soa_array<bench_record, &bench_record::id, &bench_record::price, &bench_record::quantity> table(records);
+   auto prices = table.column<&bench_record::price>();
+
+   BENCHMARK("scan one field", "array_ptr<record> (AoS)", ELEMENTS, REPETITIONS, {
+      double sum = 0;
+
+      for (std::size_t i=0; i<ELEMENTS; ++i)
+         sum += raw[i].price;
+
+      do_not_optimize(sum);
+   });
+   BENCHMARK("scan one field", "soa_array column", ELEMENTS, REPETITIONS, {
+      double sum = 0;
+
+      for (auto price : prices)
+         sum += price;
+
+      do_not_optimize(sum);
+   });
+   BENCHMARK("scan one field", "soa_array proxies", ELEMENTS, REPETITIONS, {
+      double sum = 0;
+
+      for (std::size_t i=0; i<ELEMENTS; ++i)
+         sum += table[i].get<&bench_record::price>();
+
+      do_not_optimize(sum);
+   });
+   BENCHMARK("transpose", "soa_array::assign (AoS to SoA)", ELEMENTS, REPETITIONS, {
+      table.assign(records);
+      clobber_memory();
+   });
+   BENCHMARK("transpose", "soa_array::gather_to (SoA to AoS)", ELEMENTS, REPETITIONS, {
+      table.gather_to(records);
+      clobber_memory();
+   });
+}
+
+void bench_shared(std::vector<bench_result> &results)
+{
+   using shared_array = array_ptr<std::uint32_t,std::allocator<std::uint8_t>,copy_on_write_policy<>>;
+
+   const std::size_t COPIES = 64;
+
+   array_ptr<std::uint32_t> deep(ELEMENTS);
+   shared_array shared(ELEMENTS);
+   shared.share();
+
+   BENCHMARK("copy a 4 MiB array", "array_ptr (deep copy)", COPIES, REPETITIONS, {
+      for (std::size_t i=0; i<COPIES; ++i)
+      {
+         array_ptr<std::uint32_t> copy(deep);
+         do_not_optimize(copy);
+      }
+   });
+   BENCHMARK("copy a 4 MiB array", "array_ptr (shared)", COPIES, REPETITIONS, {
+      for (std::size_t i=0; i<COPIES; ++i)
+      {
+         shared_array copy(shared);
+         do_not_optimize(copy);
+      }
+   });
+   BENCHMARK("copy a 4 MiB array", "array_ptr (shared, then written)", COPIES, REPETITIONS, {
+      for (std::size_t i=0; i<COPIES; ++i)
+      {
+         shared_array copy(shared);
+         copy[0] = static_cast<std::uint32_t>(i);
+         do_not_optimize(copy);
+      }
+   });
+}
+
+void bench_records(std::vector<bench_result> &results)
+{
+   const std::size_t RECORDS = 1 << 18;
+
+   array_ptr<std::uint8_t> buffer;
+
+   // records of 1 to 8 entries, each padded to 8 bytes
+   for (std::size_t i=0; i<RECORDS; ++i)
+   {
+      std::uint32_t entries = static_cast<std::uint32_t>(i % 8 + 1);
+      std::uint8_t bytes[40] = {};
+      std::uint32_t length = 8 + entries * 4;
+
+      std::memcpy(bytes, &entries, sizeof(entries));
+      buffer.append(bytes, align<std::size_t>(length, 8));
+   }
+
+   auto record_length = [](const bench_flexible &record) { return static_cast<std::size_t>(8 + record.count * 4); };
+   auto records = make_record_stream<bench_flexible,std::uint32_t>(buffer, record_length, 8);
+   using record_flexible = flexible_ptr<bench_flexible,std::uint32_t>;
+
+   BENCHMARK("record walk", "raw pointer", RECORDS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      auto data = buffer.get();
+      for (std::size_t offset=0; offset<buffer.size();)
+      {
+         auto record = reinterpret_cast<const bench_flexible *>(data + offset);
+         for (std::uint32_t i=0; i<record->count; ++i) sum += record->entries[i];
+         offset += align<std::size_t>(8 + record->count * 4, 8);
+      }
+      do_not_optimize(sum);
+   });
+   BENCHMARK("record walk", "flexible_ptr::set per record", RECORDS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      record_flexible record;
+      for (std::size_t offset=0; offset<buffer.size();)
+      {
+         auto header = reinterpret_cast<const bench_flexible *>(buffer.get() + offset);
+         record.set(header, header->count);
+         for (auto entry : std::as_const(record)) sum += entry;
+         offset += align<std::size_t>(record.size(), 8);
+      }
+      do_not_optimize(sum);
+   });
+   BENCHMARK("record walk", "record_stream::iterator", RECORDS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      for (auto record : records)
+         for (auto entry : record) sum += entry;
+      do_not_optimize(sum);
+   });
+   BENCHMARK("record walk", "record_stream::for_each", RECORDS, REPETITIONS, {
+      std::uint32_t sum = 0;
+      records.for_each([&](const auto &record) { for (auto entry : record) sum += entry; });
+      do_not_optimize(sum);
+   });
+}
+
+void bench_cursor(std::vector<bench_result> &results)
+{
+   const std::size_t MESSAGES = 1 << 16;
+   const std::size_t MESSAGE_SIZE = 16;
+
+   // each message is an id, a quantity, a price and a flags field
+   array_ptr<std::uint8_t> buffer(MESSAGES * MESSAGE_SIZE);
+
+   for (std::size_t i=0; i<buffer.size(); ++i)
+      buffer[i] = static_cast<std::uint8_t>(i * 7);
+
+   BENCHMARK("decode 16-byte messages", "raw pointer + memcpy", MESSAGES, REPETITIONS, {
+      std::uint64_t sum = 0;
+      auto data = buffer.get();
+      for (std::size_t i=0; i<MESSAGES; ++i)
+      {
+         std::uint32_t id;
+         std::uint32_t quantity;
+         std::uint32_t price;
+         std::uint16_t flags;
+         std::memcpy(&id, data, 4); std::memcpy(&quantity, data + 4, 4);
+         std::memcpy(&price, data + 8, 4); std::memcpy(&flags, data + 12, 2);
+         data += MESSAGE_SIZE;
+         sum += id + quantity + price + flags;
+      }
+      do_not_optimize(sum);
+   });
+   BENCHMARK("decode 16-byte messages", "basic_ptr::ptr_at per field", MESSAGES, REPETITIONS, {
+      std::uint64_t sum = 0;
+      for (std::size_t offset=0; offset<buffer.size(); offset+=MESSAGE_SIZE)
+      {
+         sum += *buffer.ptr_at<std::uint32_t>(offset, false) + *buffer.ptr_at<std::uint32_t>(offset + 4, false);
+         sum += *buffer.ptr_at<std::uint32_t>(offset + 8, false) + *buffer.ptr_at<std::uint16_t>(offset + 12, false);
+      }
+      do_not_optimize(sum);
+   });
+   BENCHMARK("decode 16-byte messages", "byte_cursor::read", MESSAGES, REPETITIONS, {
+      std::uint64_t sum = 0;
+      const_byte_cursor cursor(buffer);
+      while (!cursor.at_end())
+      {
+         sum += cursor.read<std::uint32_t>() + cursor.read<std::uint32_t>();
+         sum += cursor.read<std::uint32_t>() + cursor.read<std::uint16_t>();
+         cursor.skip(2);
+      }
+      do_not_optimize(sum);
+   });
+   BENCHMARK("decode 16-byte messages", "byte_cursor::reserve", MESSAGES, REPETITIONS, {
+      std::uint64_t sum = 0;
+      const_byte_cursor cursor(buffer);
+      while (!cursor.at_end())
+      {
+         auto group = cursor.reserve(MESSAGE_SIZE);
+         sum += group.read<std::uint32_t>() + group.read<std::uint32_t>();
+         sum += group.read<std::uint32_t>() + group.read<std::uint16_t>();
+      }
+      do_not_optimize(sum);
+   });
+}
+
+void bench_io(std::vector<bench_result> &results)
+{
+#ifdef PTRTOOLS_HAS_MMAP
+   const std::size_t SENDS = 256;
+   const std::size_t PAYLOADS = 8;
+
+   struct_ptr<bench_record> header(true);
+   flexible_ptr<bench_flexible,std::uint32_t> body(256);
+   std::vector<array_ptr<std::uint8_t>> payloads;
+
+   for (std::size_t i=0; i<PAYLOADS; ++i)
+      payloads.emplace_back(64 * 1024);
+
+   int fd = ::open("/dev/null", O_WRONLY);
+
+   BENCHMARK("send header, body and 8 x 64 KiB payloads", "clone into one buffer + write", SENDS, REPETITIONS, {
+      for (std::size_t i=0; i<SENDS; ++i)
+      {
+         array_ptr<std::uint8_t> message(header.size() + body.size() + PAYLOADS * 64 * 1024, allocation_mode::uninitialized);
+         std::size_t offset = 0;
+         message.copy(reinterpret_cast<const std::uint8_t *>(header.get()), header.size(), offset); offset += header.size();
+         message.copy(reinterpret_cast<const std::uint8_t *>(body.get()), body.size(), offset); offset += body.size();
+         for (auto &payload : payloads) { message.copy(payload.get(), payload.size(), offset); offset += payload.size(); }
+         do_not_optimize(::write(fd, message.get(), message.size()));
+      }
+   });
+   BENCHMARK("send header, body and 8 x 64 KiB payloads", "io_vector::write", SENDS, REPETITIONS, {
+      for (std::size_t i=0; i<SENDS; ++i)
+      {
+         auto message = io_vector::of(header, body);
+         for (auto &payload : payloads) message.add(payload);
+         do_not_optimize(message.write(fd));
+      }
+   });
+
+   ::close(fd);
+#endif
+}
+
+std::uint64_t checksum(const std::uint8_t *data, std::size_t size, std::uint64_t hash)
+{
+   for (std::size_t i=0; i<size; ++i)
+      hash = (hash ^ data[i]) * 0x100000001B3ULL;
+
+   return hash;
+}
+
+void bench_chunked(std::vector<bench_result> &results)
+{
+#ifdef PTRTOOLS_HAS_MMAP
+   const std::size_t FILE_SIZE = 64 * 1024 * 1024;
+   const std::size_t CHUNK_SIZE = 1024 * 1024;
+   auto path = (std::filesystem::temp_directory_path() / "ptrtools_bench_chunked.bin").string();
+
+   {
+      array_ptr<std::uint8_t> contents(FILE_SIZE);
+      std::ofstream output(path, std::ios::binary | std::ios::trunc);
+      output.write(reinterpret_cast<const char *>(contents.get()), FILE_SIZE);
+   }
+
+   BENCHMARK("read and checksum a 64 MiB file", "pread then process", FILE_SIZE, 3, {
+      int fd = ::open(path.c_str(), O_RDONLY);
+      array_ptr<std::uint8_t> buffer(CHUNK_SIZE, allocation_mode::uninitialized);
+      std::uint64_t hash = 0xCBF29CE484222325ULL;
+      std::uint64_t offset = 0;
+      for (ssize_t result; (result = ::pread(fd, buffer.get(), CHUNK_SIZE, static_cast<off_t>(offset))) > 0; offset += static_cast<std::uint64_t>(result))
+         hash = checksum(buffer.get(), static_cast<std::size_t>(result), hash);
+      ::close(fd);
+      do_not_optimize(hash);
+   });
+   BENCHMARK("read and checksum a 64 MiB file", "chunked_reader", FILE_SIZE, 3, {
+      chunked_reader reader(path, CHUNK_SIZE);
+      std::uint64_t hash = 0xCBF29CE484222325ULL;
+      for (auto chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+         hash = checksum(chunk.data(), chunk.size(), hash);
+      do_not_optimize(hash);
+   });
+
+   std::filesystem::remove(path);
+#endif
+}
+
+int
+main
+(int argc, char *argv[])
+{
+   BENCH_INIT();
+
+   bench_access(results);
+   bench_iterators(results);
+   bench_sort(results);
+   bench_flexible_access(results);
+   bench_memory(results);
+   bench_construction(results);
+   bench_allocators(results);
+   bench_mapped(results);
+   bench_alignment(results);
+   bench_simd(results);
+   bench_search(results);
+   bench_endian(results);
+   bench_parallel(results);
+   bench_strided(results);
+   bench_soa(results);
+   bench_shared(results);
+   bench_records(results);
+   bench_cursor(results);
+   bench_io(results);
+   bench_chunked(results);
+
+   BENCH_COMPLETE(argc > 1 ? argv[1] : nullptr);
+}
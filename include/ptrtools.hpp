@@ -1,10 +1,31 @@
 #ifndef __PTRTOOLS_HPP
 #define __PTRTOOLS_HPP
 
+#include <ptrtools/aligned.hpp>
+#include <ptrtools/arena.hpp>
 #include <ptrtools/array.hpp>
 #include <ptrtools/basic.hpp>
+#include <ptrtools/caching.hpp>
+#include <ptrtools/chunked.hpp>
+#include <ptrtools/cursor.hpp>
+#include <ptrtools/endian.hpp>
 #include <ptrtools/flexible.hpp>
+#include <ptrtools/handle.hpp>
+#include <ptrtools/instrument.hpp>
+#include <ptrtools/io.hpp>
+#include <ptrtools/iterator.hpp>
+#include <ptrtools/mapped.hpp>
+#include <ptrtools/memory.hpp>
+#include <ptrtools/parallel.hpp>
+#include <ptrtools/pmr.hpp>
+#include <ptrtools/policy.hpp>
+#include <ptrtools/record.hpp>
+#include <ptrtools/search.hpp>
+#include <ptrtools/simd.hpp>
+#include <ptrtools/soa.hpp>
+#include <ptrtools/strided.hpp>
 #include <ptrtools/struct.hpp>
 #include <ptrtools/utility.hpp>
+#include <ptrtools/view.hpp>
 
 #endif
@@ -0,0 +1,92 @@
+#ifndef __PTRTOOLS_ALIGNED_HPP
+#define __PTRTOOLS_ALIGNED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include <ptrtools/memory.hpp>
+#include <ptrtools/utility.hpp>
+
+namespace ptrtools
+{
+   // Allocator returning blocks aligned to at least Alignment bytes, e.g. cache lines for tables
+   // shared between threads or vector widths for SIMD loads.
+   template <typename T=std::uint8_t, std::size_t Alignment=64>
+   class aligned_allocator
+   {
+      static_assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+   public:
+      using value_type = T;
+      using is_always_equal = std::true_type;
+
+      const static std::size_t alignment = Alignment > alignof(T) ? Alignment : alignof(T);
+
+      template <typename U>
+      struct rebind { using other = aligned_allocator<U,Alignment>; };
+
+      aligned_allocator() {}
+      template <typename U>
+      aligned_allocator(const aligned_allocator<U,Alignment> &other) { (void)other; }
+
+      template <typename U>
+      bool operator==(const aligned_allocator<U,Alignment> &other) const { (void)other; return true; }
+      template <typename U>
+      bool operator!=(const aligned_allocator<U,Alignment> &other) const { (void)other; return false; }
+
+      T *allocate(std::size_t n) { return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignment))); }
+      void deallocate(T *ptr, std::size_t n) { (void)n; ::operator delete(ptr, std::align_val_t(alignment)); }
+   };
+
+   // Allocator backing blocks of a huge page or more with huge-page mappings, cutting TLB misses
+   // on large tables. Smaller blocks come from the regular heap. Mapped blocks are rounded up to
+   // whole huge pages, so this is meant for a few big buffers rather than many small ones.
+   template <typename T=std::uint8_t, huge_page_mode Mode=huge_page_mode::transparent>
+   class huge_page_allocator
+   {
+   public:
+      using value_type = T;
+      using is_always_equal = std::true_type;
+
+      const static std::size_t alignment = allocator_alignment<std::allocator<T>>::value;
+
+      template <typename U>
+      struct rebind { using other = huge_page_allocator<U,Mode>; };
+
+      huge_page_allocator() {}
+      template <typename U>
+      huge_page_allocator(const huge_page_allocator<U,Mode> &other) { (void)other; }
+
+      template <typename U>
+      bool operator==(const huge_page_allocator<U,Mode> &other) const { (void)other; return true; }
+      template <typename U>
+      bool operator!=(const huge_page_allocator<U,Mode> &other) const { (void)other; return false; }
+
+      T *allocate(std::size_t n) {
+         auto size = n * sizeof(T);
+
+         if (size < huge_page_size || !pages_available())
+            return std::allocator<T>().allocate(n);
+
+         auto result = map_huge_pages(align(size, huge_page_size), Mode);
+
+         if (result == nullptr)
+            throw std::bad_alloc();
+
+         return static_cast<T *>(result);
+      }
+      void deallocate(T *ptr, std::size_t n) {
+         auto size = n * sizeof(T);
+
+         if (size < huge_page_size || !pages_available())
+            std::allocator<T>().deallocate(ptr, n);
+         else
+            unmap_pages(ptr, align(size, huge_page_size));
+      }
+   };
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef __PTRTOOLS_ARENA_HPP
+#define __PTRTOOLS_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include <ptrtools/basic.hpp>
+#include <ptrtools/memory.hpp>
+#include <ptrtools/utility.hpp>
+
+namespace ptrtools
+{
+   // A monotonic region: allocations bump an offset through a single block and are only released
+   // in bulk with reset(). Everything built on top of an arena must be done with its memory by then.
+   class arena
+   {
+   public:
+      using region_type = basic_ptr<std::uint8_t>;
+
+   private:
+      region_type _region;
+      std::size_t _offset = 0;
+
+   public:
+      arena(std::size_t size) : _region(size, allocation_mode::uninitialized) {}
+      arena(std::uint8_t *ptr, std::size_t size) : _region(ptr, size) {}
+      arena(const arena &other) = delete;
+      arena &operator=(const arena &other) = delete;
+
+      void *allocate(std::size_t size, std::size_t alignment=alignof(std::max_align_t)) {
+         auto base = reinterpret_cast<std::uintptr_t>(this->_region.get());
+         auto start = align(base + this->_offset, static_cast<std::uintptr_t>(alignment)) - base;
+
+         if (start > this->_region.size() || size > this->_region.size() - start)
+            throw std::bad_alloc();
+
+         this->_offset = start + size;
+
+         return reinterpret_cast<void *>(base + start);
+      }
+      // Individual blocks are never handed back. A pointer released after reset() cannot be told
+      // apart from a live block at the same place, so rewinding the offset for it would hand that
+      // live block out again.
+      void deallocate(void *, std::size_t) {}
+      void reset() { this->_offset = 0; }
+
+      bool owns(const void *ptr) const {
+         auto base = reinterpret_cast<std::uintptr_t>(this->_region.get());
+         auto address = reinterpret_cast<std::uintptr_t>(ptr);
+
+         return address >= base && address < base + this->_region.size();
+      }
+      std::size_t size() const { return this->_region.size(); }
+      std::size_t used() const { return this->_offset; }
+      std::size_t remaining() const { return this->_region.size() - this->_offset; }
+   };
+
+   // Allocator handle over an arena. It is a single pointer, propagates with its container and
+   // compares equal only to handles over the same arena. Blocks are aligned to at least
+   // max_align_t since byte allocators back basic_ptr objects of any type.
+   template <typename T=std::uint8_t>
+   class arena_allocator
+   {
+   public:
+      using value_type = T;
+      using propagate_on_container_copy_assignment = std::true_type;
+      using propagate_on_container_move_assignment = std::true_type;
+      using propagate_on_container_swap = std::true_type;
+      using is_always_equal = std::false_type;
+
+      const static std::size_t alignment = alignof(T) > alignof(std::max_align_t) ? alignof(T) : alignof(std::max_align_t);
+
+      template <typename U>
+      struct rebind { using other = arena_allocator<U>; };
+
+   private:
+      arena *_arena;
+
+   public:
+      arena_allocator(arena &region) : _arena(&region) {}
+      template <typename U>
+      arena_allocator(const arena_allocator<U> &other) : _arena(other.get_arena()) {}
+
+      template <typename U>
+      bool operator==(const arena_allocator<U> &other) const { return this->_arena == other.get_arena(); }
+      template <typename U>
+      bool operator!=(const arena_allocator<U> &other) const { return this->_arena != other.get_arena(); }
+
+      T *allocate(std::size_t n) { return static_cast<T *>(this->_arena->allocate(n * sizeof(T), alignment)); }
+      void deallocate(T *ptr, std::size_t n) { this->_arena->deallocate(ptr, n * sizeof(T)); }
+
+      arena *get_arena() const { return this->_arena; }
+   };
+}
+
+#endif
@@ -1,26 +1,41 @@
 #ifndef __PTRTOOLS_ARRAY_HPP
 #define __PTRTOOLS_ARRAY_HPP
 
+#include <algorithm>
+
 #include <ptrtools/basic.hpp>
+#include <ptrtools/endian.hpp>
+#include <ptrtools/simd.hpp>
+#include <ptrtools/strided.hpp>
 
 namespace ptrtools
 {
-   template <typename T, typename Allocator=std::allocator<std::uint8_t>>
-   class array_ptr : public basic_ptr<T,sizeof(T),alignof(T),Allocator>
+   template <typename T, typename Allocator=std::allocator<std::uint8_t>, typename CheckPolicy=default_policy>
+   class array_ptr : public basic_ptr<T,sizeof(T),alignof(T),Allocator,CheckPolicy>
    {
    public:
-      using basic_ptr_decl = basic_ptr<T,sizeof(T),alignof(T),Allocator>;
+      using basic_ptr_decl = basic_ptr<T,sizeof(T),alignof(T),Allocator,CheckPolicy>;
       using value_type = typename basic_ptr_decl::value_type;
       using pointer = typename basic_ptr_decl::pointer;
       using const_pointer = typename basic_ptr_decl::const_pointer;
       using reference = typename basic_ptr_decl::reference;
       using const_reference = typename basic_ptr_decl::const_reference;
       using allocator = Allocator;
+      using check_policy = CheckPolicy;
+      using view_type = array_view<T,CheckPolicy>;
+      using const_view_type = array_view<const T,CheckPolicy>;
+
+      const static std::size_t npos = static_cast<std::size_t>(-1);
 
       array_ptr() : basic_ptr_decl(false) {}
-      array_ptr(std::size_t elements) {
+      array_ptr(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
+         if (elements > 0)
+            this->allocate(elements, mode);
+      }
+      array_ptr(const Allocator &allocator) : basic_ptr_decl(allocator) {}
+      array_ptr(std::size_t elements, const Allocator &allocator, allocation_mode mode=allocation_mode::zeroed) : basic_ptr_decl(allocator) {
          if (elements > 0)
-            this->allocate(elements);
+            this->allocate(elements, mode);
       }
       array_ptr(pointer ptr, std::size_t elements, bool clone=false) {
          if (clone)
@@ -36,22 +51,22 @@ namespace ptrtools
       }
       array_ptr(basic_ptr_decl &ptr) : basic_ptr_decl(ptr) {}
       array_ptr(const basic_ptr_decl &ptr) : basic_ptr_decl(ptr) {}
-      array_ptr(array_ptr<T,Allocator> &other) : basic_ptr_decl(static_cast<basic_ptr_decl &>(other)) {}
-      array_ptr(const array_ptr<T,Allocator> &other) : basic_ptr_decl(static_cast<const basic_ptr_decl &>(other)) {}
-      array_ptr(array_ptr<T,Allocator> &&other) : basic_ptr_decl(static_cast<basic_ptr_decl &&>(other)) {}
+      array_ptr(array_ptr<T,Allocator,CheckPolicy> &other) : basic_ptr_decl(static_cast<basic_ptr_decl &>(other)) {}
+      array_ptr(const array_ptr<T,Allocator,CheckPolicy> &other) : basic_ptr_decl(static_cast<const basic_ptr_decl &>(other)) {}
+      array_ptr(array_ptr<T,Allocator,CheckPolicy> &&other) : basic_ptr_decl(static_cast<basic_ptr_decl &&>(other)) {}
       ~array_ptr() {}
 
-      array_ptr<T,Allocator> &operator=(array_ptr<T,Allocator> &other) {
+      array_ptr<T,Allocator,CheckPolicy> &operator=(array_ptr<T,Allocator,CheckPolicy> &other) {
          basic_ptr_decl::operator=(static_cast<basic_ptr_decl &>(other));
 
          return *this;
       }
-      array_ptr<T,Allocator> &operator=(const array_ptr<T,Allocator> &other) {
+      array_ptr<T,Allocator,CheckPolicy> &operator=(const array_ptr<T,Allocator,CheckPolicy> &other) {
          basic_ptr_decl::operator=(static_cast<const basic_ptr_decl &>(other));
 
          return *this;
       }
-      array_ptr<T,Allocator> &operator=(array_ptr<T,Allocator> &&other) {
+      array_ptr<T,Allocator,CheckPolicy> &operator=(array_ptr<T,Allocator,CheckPolicy> &&other) {
          basic_ptr_decl::operator=(static_cast<basic_ptr_decl &&>(other));
 
          return *this;
@@ -59,19 +74,55 @@ namespace ptrtools
 
    private:
       using basic_ptr_decl::operator->;
+      using basic_ptr_decl::view;
+      using basic_ptr_decl::slice;
       using basic_ptr_decl::allocate;
       using basic_ptr_decl::reallocate;
+      using basic_ptr_decl::reserve;
+      using basic_ptr_decl::capacity;
       using basic_ptr_decl::resize;
       using basic_ptr_decl::set;
       using basic_ptr_decl::clone;
       using basic_ptr_decl::copy;
 
    public:
-      void allocate(std::size_t elements) {
-         basic_ptr_decl::allocate(elements * this->aligned_type_size());
+      view_type view() { return view_type(basic_ptr_decl::view()); }
+      const_view_type view() const { return const_view_type(basic_ptr_decl::view()); }
+      view_type slice(std::size_t index, std::size_t elements) { return this->view().slice(index, elements); }
+      const_view_type slice(std::size_t index, std::size_t elements) const { return this->view().slice(index, elements); }
+
+      void allocate(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
+         basic_ptr_decl::allocate(elements * this->aligned_type_size(), mode);
+      }
+      void allocate(std::size_t elements, const Allocator &allocator, allocation_mode mode=allocation_mode::zeroed) {
+         basic_ptr_decl::allocate(elements * this->aligned_type_size(), allocator, mode);
+      }
+      void reallocate(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
+         auto size = elements * this->aligned_type_size();
+
+         this->reallocate_to(size, this->grow_capacity(size), mode);
+      }
+      void reserve(std::size_t elements) {
+         basic_ptr_decl::reserve(elements * this->aligned_type_size());
+      }
+      std::size_t capacity() const {
+         return basic_ptr_decl::capacity() / this->aligned_type_size();
+      }
+      void push_back(const_reference value) {
+         this->emplace_back(value);
+      }
+      template <typename... Args>
+      reference emplace_back(Args&&... args) {
+         return *this->template emplace_tail<T>(this->aligned_type_size(), std::forward<Args>(args)...);
+      }
+      void append(const_pointer ptr, std::size_t elements) {
+         if (elements == 0)
+            return;
+
+         this->append_tail(ptr, elements * this->aligned_type_size());
       }
-      void reallocate(std::size_t elements) {
-         basic_ptr_decl::reallocate(elements * this->aligned_type_size());
+      void append(const basic_ptr_decl &other) {
+         array_ptr<T,Allocator,CheckPolicy>::append(other.get(), other.elements());
       }
       void resize(std::size_t elements) {
          basic_ptr_decl::resize(elements * this->aligned_type_size());
@@ -88,19 +139,125 @@ namespace ptrtools
          basic_ptr_decl::clone(ptr, elements * this->aligned_type_size());
       }
       void clone(const basic_ptr_decl &other) {
-         array_ptr<T,Allocator>::clone(other.get(), other.elements());
+         array_ptr<T,Allocator,CheckPolicy>::clone(other.get(), other.elements());
       }
-      void clone(const array_ptr<T,Allocator> &other) {
-         array_ptr<T,Allocator>::clone(other.get(), other.elements());
+      void clone(const array_ptr<T,Allocator,CheckPolicy> &other) {
+         array_ptr<T,Allocator,CheckPolicy>::clone(other.get(), other.elements());
       }
       void copy(const_pointer ptr, std::size_t elements, std::size_t index=0) {
          basic_ptr_decl::copy(ptr, elements * this->aligned_type_size(), index * this->aligned_type_size(), true);
       }
       void copy(const basic_ptr_decl &other, std::size_t index=0) {
-         array_ptr<T,Allocator>::copy(other.get(), other.elements(), index);
+         array_ptr<T,Allocator,CheckPolicy>::copy(other.get(), other.elements(), index);
+      }
+      void copy(const array_ptr<T,Allocator,CheckPolicy> &other, std::size_t index=0) {
+         array_ptr<T,Allocator,CheckPolicy>::copy(other.get(), other.elements(), index);
+      }
+
+      // Views one member of every element, e.g. records.field(&record::price).
+      template <typename Field, typename Class>
+      strided_view<Field,CheckPolicy> field(Field Class::*member) {
+         static_assert(std::is_base_of<Class,T>::value, "The member must belong to the element type");
+
+         auto ptr = this->get();
+
+         if (ptr == nullptr)
+            return strided_view<Field,CheckPolicy>();
+
+         return strided_view<Field,CheckPolicy>(&(ptr->*member), this->aligned_type_size(), this->elements());
       }
-      void copy(const array_ptr<T,Allocator> &other, std::size_t index=0) {
-         array_ptr<T,Allocator>::copy(other.get(), other.elements(), index);
+      template <typename Field, typename Class>
+      strided_view<const Field,CheckPolicy> field(Field Class::*member) const {
+         static_assert(std::is_base_of<Class,T>::value, "The member must belong to the element type");
+
+         auto ptr = this->get();
+
+         if (ptr == nullptr)
+            return strided_view<const Field,CheckPolicy>();
+
+         return strided_view<const Field,CheckPolicy>(&(ptr->*member), this->aligned_type_size(), this->elements());
+      }
+      template <typename Field>
+      strided_view<Field,CheckPolicy> field(std::size_t offset) {
+         auto ptr = reinterpret_cast<std::uint8_t *>(this->get());
+
+         CheckPolicy::check(offset + sizeof(Field) <= this->aligned_type_size(), "out of bounds: the field does not fit inside the element");
+         CheckPolicy::check(offset % alignof(Field) == 0, "invalid alignment: the field offset is not aligned to the field type");
+
+         if (ptr == nullptr)
+            return strided_view<Field,CheckPolicy>();
+
+         return strided_view<Field,CheckPolicy>(reinterpret_cast<Field *>(ptr + offset), this->aligned_type_size(), this->elements());
+      }
+      template <typename Field>
+      strided_view<const Field,CheckPolicy> field(std::size_t offset) const {
+         auto ptr = reinterpret_cast<const std::uint8_t *>(this->get());
+
+         CheckPolicy::check(offset + sizeof(Field) <= this->aligned_type_size(), "out of bounds: the field does not fit inside the element");
+         CheckPolicy::check(offset % alignof(Field) == 0, "invalid alignment: the field offset is not aligned to the field type");
+
+         if (ptr == nullptr)
+            return strided_view<const Field,CheckPolicy>();
+
+         return strided_view<const Field,CheckPolicy>(reinterpret_cast<const Field *>(ptr + offset), this->aligned_type_size(), this->elements());
+      }
+
+      void byteswap() {
+         simd::byteswap(this->get(), this->elements());
+      }
+      void to_native(byte_order order) {
+         if (order != byte_order::native)
+            this->byteswap();
+      }
+      void from_native(byte_order order) {
+         if (order != byte_order::native)
+            this->byteswap();
+      }
+      void fill(const_reference value) {
+         simd::fill(this->get(), this->elements(), value);
+      }
+      std::size_t find(const_reference value, std::size_t start=0) const {
+         auto elements = this->elements();
+
+         if (start >= elements)
+            return npos;
+
+         auto result = simd::find(this->get() + start, elements - start, value);
+
+         return result == elements - start ? npos : start + result;
+      }
+      std::size_t count(const_reference value) const {
+         return simd::count(this->get(), this->elements(), value);
+      }
+      bool contains(const_reference value) const {
+         return simd::contains(this->get(), this->elements(), value);
+      }
+      value_type min() const {
+         CheckPolicy::check(this->elements() > 0, "out of bounds: cannot take the minimum of an empty array");
+
+         return simd::min(this->get(), this->elements());
+      }
+      value_type max() const {
+         CheckPolicy::check(this->elements() > 0, "out of bounds: cannot take the maximum of an empty array");
+
+         return simd::max(this->get(), this->elements());
+      }
+      template <typename Other>
+      std::size_t mismatch(const Other &other) const {
+         auto elements = std::min(this->elements(), other.elements());
+         const_pointer other_ptr = other.get();
+         auto result = simd::mismatch(this->get(), other_ptr, elements);
+
+         if (result == elements && this->elements() == other.elements())
+            return npos;
+
+         return result;
+      }
+      template <typename Other>
+      bool equal(const Other &other) const {
+         const_pointer other_ptr = other.get();
+
+         return this->elements() == other.elements() && simd::equal(this->get(), other_ptr, this->elements());
       }
    };
 }
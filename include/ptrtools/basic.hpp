@@ -2,17 +2,27 @@
 #define __PTRTOOLS_BASIC_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <exception>
 #include <memory>
-#include <optional>
+#include <new>
+#include <string_view>
 #include <type_traits>
 #include <utility>
-#include <variant>
-
+#include <vector>
+
+#include <ptrtools/handle.hpp>
+#include <ptrtools/instrument.hpp>
+#include <ptrtools/iterator.hpp>
+#include <ptrtools/memory.hpp>
+#include <ptrtools/policy.hpp>
+#include <ptrtools/search.hpp>
 #include <ptrtools/utility.hpp>
+#include <ptrtools/view.hpp>
 
 namespace ptrtools
 {
@@ -20,7 +30,8 @@ namespace ptrtools
       typename T,
       std::size_t TypeSize=sizeof(T),
       std::size_t TypeAlign=alignof(T),
-      typename Allocator=std::allocator<std::uint8_t>>
+      typename Allocator=std::allocator<std::uint8_t>,
+      typename CheckPolicy=default_policy>
    class basic_ptr
    {
       static_assert(!std::is_same<T,void>::value, "Type cannot be void");
@@ -33,253 +44,428 @@ namespace ptrtools
       using reference = value_type &;
       using const_reference = const value_type &;
       using allocator = Allocator;
+      using check_policy = CheckPolicy;
+      using view_type = basic_view<T,TypeSize,TypeAlign,CheckPolicy>;
+      using const_view_type = basic_view<const T,TypeSize,TypeAlign,CheckPolicy>;
 
       const static std::size_t type_size = TypeSize;
       const static std::size_t type_align = TypeAlign;
+      const static std::size_t type_stride = align(TypeSize, TypeAlign);
+      const static std::size_t npos = static_cast<std::size_t>(-1);
+      const static bool copy_on_write = is_copy_on_write<CheckPolicy>::value;
 
    protected:
-      std::variant<pointer, const_pointer> _ptr;
-      std::size_t _size;
-      std::optional<Allocator> _allocator;
-
-   public:
-      class iterator
+      pointer _ptr = nullptr;
+      bool _const = false;
+      std::size_t _size = 0;
+      std::size_t _capacity = 0;
+      bool _allocated = false;
+      bool _mapped = false;
+      Allocator _allocator;
+
+      using allocator_traits = std::allocator_traits<Allocator>;
+
+      // Ownership record of a buffer shared between copies. The buffer is released by whichever
+      // owner drops the count to zero.
+      struct shared_block
       {
-      public:
-         using iterator_category = std::forward_iterator_tag;
-         using difference_type = std::ptrdiff_t;
-         using value_type = T;
-         using pointer = iterator::value_type *;
-         using reference = iterator::value_type &;
-
-      private:
-         basic_ptr<T,TypeSize,TypeAlign,Allocator> *_base;
-         iterator::pointer _iter;
-
-      public:
-         iterator(basic_ptr<T,TypeSize,TypeAlign,Allocator> &base, bool end=false) : _base(&base) {
-            if (end)
-               this->_iter = base.eob();
-            else
-               this->_iter = base.get();
-         }
-         iterator(const iterator &other) : _base(other._base), _iter(other._iter) {}
-         ~iterator() {}
+         std::atomic<std::size_t> count{1};
+      };
 
-         iterator &operator=(const iterator &other) {
-            this->_base = other._base;
-            this->_iter = other._iter;
+      using shared_allocator = typename allocator_traits::template rebind_alloc<shared_block>;
 
-            return *this;
-         }
-         iterator &operator++() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to advance an iterator on a null pointer");
+      shared_block *_shared = nullptr;
 
-            auto uintptr_cast = reinterpret_cast<std::uintptr_t>(this->_iter);
-            auto size = this->_base->aligned_type_size();
+      // std::allocator draws from the same heap as malloc, so when it is the allocator in use and
+      // the type needs no more than the fundamental alignment, blocks are obtained with malloc and
+      // can be grown in place with realloc (which uses mremap for large blocks on glibc). Large
+      // lazily-zeroed blocks for std::allocator come from anonymous mappings instead.
+      const static bool uses_default_allocator = std::is_same<Allocator,std::allocator<std::uint8_t>>::value;
+      const static bool uses_system_heap = uses_default_allocator && TypeAlign <= alignof(std::max_align_t);
 
-            this->_iter = reinterpret_cast<iterator::pointer>(uintptr_cast+size);
+      // When the allocator cannot promise TypeAlign on its own, it is rebound to a unit type of that
+      // alignment, which every conforming allocator has to honour.
+      const static bool uses_aligned_units = !uses_system_heap && TypeAlign > allocator_alignment<Allocator>::value;
 
-            return *this;
-         }
-         iterator operator++(int) { auto &tmp = *this; ++(*this); return tmp; }
-         bool operator==(const iterator &other) const { return other._base == this->_base && other._iter == this->_iter; }
-         bool operator!=(const iterator &other) const { return !(*this == other); }
-         iterator::reference operator*() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to dereference an iterator on a null pointer");
-
-            return *this->_iter;
+      struct alignas(TypeAlign) aligned_unit
+      {
+         std::uint8_t bytes[TypeAlign];
+      };
+
+      void take(basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) {
+         this->_ptr = other._ptr;
+         this->_const = other._const;
+         this->_size = other._size;
+         this->_capacity = other._capacity;
+         this->_allocated = other._allocated;
+         this->_mapped = other._mapped;
+         this->_shared = other._shared;
+
+         other._ptr = nullptr;
+         other._const = false;
+         other._size = 0;
+         other._capacity = 0;
+         other._allocated = false;
+         other._mapped = false;
+         other._shared = nullptr;
+      }
+      void propagate_copy(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) {
+         if constexpr (allocator_traits::propagate_on_container_copy_assignment::value)
+         {
+            if (this->is_allocated() && !(this->_allocator == other._allocator))
+               this->deallocate();
+
+            this->_allocator = other._allocator;
          }
-         iterator::pointer operator->() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to dereference an iterator on a null pointer");
+      }
 
-            return this->_iter;
+      std::uint8_t *allocator_allocate(std::size_t size) {
+         if constexpr (uses_aligned_units)
+         {
+            using unit_allocator = typename allocator_traits::template rebind_alloc<aligned_unit>;
+            unit_allocator units(this->_allocator);
+
+            return reinterpret_cast<std::uint8_t *>(std::allocator_traits<unit_allocator>::allocate(units, (size + TypeAlign - 1) / TypeAlign));
          }
-      };
-      class const_iterator
-      {
-      public:
-         using iterator_category = std::forward_iterator_tag;
-         using difference_type = std::ptrdiff_t;
-         using value_type = const T;
-         using pointer = const_iterator::value_type *;
-         using reference = const_iterator::value_type &;
-
-      private:
-         const basic_ptr<T,TypeSize,TypeAlign,Allocator> *_base;
-         const_iterator::pointer _iter;
-
-      public:
-         const_iterator(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &base, bool end=false) : _base(&base) {
-            if (end)
-               this->_iter = base.eob();
-            else
-               this->_iter = base.get();
+         else
+            return allocator_traits::allocate(this->_allocator, size);
+      }
+      void allocator_deallocate(std::uint8_t *ptr, std::size_t size) {
+         if constexpr (uses_aligned_units)
+         {
+            using unit_allocator = typename allocator_traits::template rebind_alloc<aligned_unit>;
+            unit_allocator units(this->_allocator);
+
+            std::allocator_traits<unit_allocator>::deallocate(units, reinterpret_cast<aligned_unit *>(ptr), (size + TypeAlign - 1) / TypeAlign);
          }
-         const_iterator(const const_iterator &other) : _base(other._base), _iter(other._iter) {}
-         ~const_iterator() {}
+         else
+            allocator_traits::deallocate(this->_allocator, ptr, size);
+      }
 
-         const_iterator &operator=(const const_iterator &other) {
-            this->_base = other._base;
-            this->_iter = other._iter;
+      std::uint8_t *heap_acquire(std::size_t size, allocation_mode mode) {
+         this->_mapped = false;
 
-            return *this;
+         if constexpr (uses_default_allocator)
+         {
+            if (mode == allocation_mode::lazily_zeroed && size >= lazy_mapping_threshold && TypeAlign <= page_size())
+            {
+               if (auto result = map_pages(size))
+               {
+                  this->_mapped = true;
+                  return static_cast<std::uint8_t *>(result);
+               }
+            }
          }
-         const_iterator &operator++() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to advance an const_iterator on a null pointer");
 
-            auto uintptr_cast = reinterpret_cast<std::uintptr_t>(this->_iter);
-            auto size = this->_base->aligned_type_size();
+         if constexpr (uses_system_heap)
+         {
+            auto result = static_cast<std::uint8_t *>(mode == allocation_mode::lazily_zeroed ? std::calloc(1, size) : std::malloc(size));
 
-            this->_iter = reinterpret_cast<const_iterator::pointer>(uintptr_cast+size);
+            if (result == nullptr)
+               throw std::bad_alloc();
 
-            return *this;
+            if (mode == allocation_mode::zeroed)
+               std::memset(result, 0, size);
+
+            return result;
          }
-         const_iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
-         bool operator==(const const_iterator &other) const { return other._base == this->_base && other._iter == this->_iter; }
-         bool operator!=(const const_iterator &other) const { return !(*this == other); }
-         const_iterator::reference operator*() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to dereference an iterator on a null pointer");
-
-            return *this->_iter;
+         else
+         {
+            auto result = this->allocator_allocate(size);
+
+            if (mode != allocation_mode::uninitialized)
+               std::memset(result, 0, size);
+
+            return result;
          }
-         const_iterator::pointer operator->() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to dereference an iterator on a null pointer");
+      }
+      std::uint8_t *heap_allocate(std::size_t size, allocation_mode mode) {
+         auto result = this->heap_acquire(size, mode);
+
+         instrument::record<T>(instrument::event::allocate, size);
+         instrument::record_live<T>(static_cast<std::int64_t>(size));
+
+         return result;
+      }
+      void heap_release(std::uint8_t *ptr, std::size_t size, bool mapped) {
+         instrument::record<T>(instrument::event::deallocate, size);
+         instrument::record_live<T>(-static_cast<std::int64_t>(size));
+
+         if (mapped)
+            unmap_pages(ptr, size);
+         else if constexpr (uses_system_heap)
+            std::free(ptr);
+         else
+            this->allocator_deallocate(ptr, size);
+      }
+      void heap_deallocate(std::uint8_t *ptr, std::size_t size) {
+         this->heap_release(ptr, size, this->_mapped);
+         this->_mapped = false;
+      }
 
-            return this->_iter;
+      shared_block *create_shared() {
+         shared_allocator blocks(this->_allocator);
+         auto block = std::allocator_traits<shared_allocator>::allocate(blocks, 1);
+
+         return new (block) shared_block();
+      }
+      void destroy_shared(shared_block *block) {
+         shared_allocator blocks(this->_allocator);
+
+         block->~shared_block();
+         std::allocator_traits<shared_allocator>::deallocate(blocks, block, 1);
+      }
+      void release_shared(shared_block *block, std::uint8_t *ptr, std::size_t size, bool mapped) {
+         // acq_rel: the owner that frees the buffer must see every other owner's reads finish first
+         if (block->count.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+         this->destroy_shared(block);
+         this->heap_release(ptr, size, mapped);
+      }
+      bool shared_elsewhere() const {
+         if constexpr (copy_on_write)
+            return this->_shared != nullptr && this->_shared->count.load(std::memory_order_acquire) > 1;
+         else
+            return false;
+      }
+      void share_with(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) {
+         // count the new owner before releasing our own buffer, which may be the same one
+         other._shared->count.fetch_add(1, std::memory_order_relaxed);
+
+         if (this->is_allocated())
+            this->deallocate();
+
+         this->_ptr = other._ptr;
+         this->_const = false;
+         this->_size = other._size;
+         this->_capacity = other._capacity;
+         this->_allocated = true;
+         this->_mapped = other._mapped;
+         this->_shared = other._shared;
+      }
+      // Moves this owner onto a private copy of the shared buffer with the given capacity. The copy
+      // is shared again on its own, so later copies of this pointer keep sharing.
+      void unshare(std::size_t capacity) {
+         auto old_ptr = reinterpret_cast<std::uint8_t *>(this->_ptr);
+         auto old_capacity = this->_capacity;
+         auto old_mapped = this->_mapped;
+         auto old_shared = this->_shared;
+         auto new_shared = this->create_shared();
+         std::uint8_t *new_ptr;
+
+         try
+         {
+            new_ptr = this->heap_allocate(capacity, allocation_mode::uninitialized);
          }
-      };
-      class reverse_iterator
-      {
-      public:
-         using iterator_category = std::forward_iterator_tag;
-         using difference_type = std::ptrdiff_t;
-         using value_type = T;
-         using pointer = reverse_iterator::value_type *;
-         using reference = reverse_iterator::value_type &;
-
-      private:
-         basic_ptr<T,TypeSize,TypeAlign,Allocator> *_base;
-         reverse_iterator::pointer _iter;
-
-      public:
-         reverse_iterator(basic_ptr<T,TypeSize,TypeAlign,Allocator> &base, bool end=false) : _base(&base) {
-            if (end)
-               this->_iter = base.reob();
-            else if (base.elements() > 0)
-               this->_iter = &base.back();
-            else
-               this->_iter = base.get();
+         catch (...)
+         {
+            this->_mapped = old_mapped;
+            this->destroy_shared(new_shared);
+            throw;
          }
-         reverse_iterator(const reverse_iterator &other) : _base(other._base), _iter(other._iter) {}
-         ~reverse_iterator() {}
 
-         reverse_iterator &operator=(const reverse_iterator &other) {
-            this->_base = other._base;
-            this->_iter = other._iter;
+         std::memcpy(new_ptr, old_ptr, std::min(this->_size, capacity));
+         instrument::record<T>(instrument::event::clone, std::min(this->_size, capacity));
 
-            return *this;
+         this->_ptr = reinterpret_cast<pointer>(new_ptr);
+         this->_capacity = capacity;
+         this->_shared = new_shared;
+
+         if (this->_size > capacity)
+            this->_size = capacity;
+
+         this->release_shared(old_shared, old_ptr, old_capacity, old_mapped);
+      }
+      void reallocate_capacity(std::size_t capacity) {
+         if (this->shared_elsewhere())
+         {
+            this->unshare(capacity);
+            return;
          }
-         reverse_iterator &operator++() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to advance an iterator on a null pointer");
 
-            auto uintptr_cast = reinterpret_cast<std::uintptr_t>(this->_iter);
-            auto size = this->_base->aligned_type_size();
+         auto old_ptr = reinterpret_cast<std::uint8_t *>(this->_ptr);
+         std::uint8_t *new_ptr;
 
-            this->_iter = reinterpret_cast<reverse_iterator::pointer>(uintptr_cast-size);
+         if (this->_mapped)
+         {
+            new_ptr = static_cast<std::uint8_t *>(remap_pages(old_ptr, this->_capacity, capacity));
 
-            return *this;
-         }
-         reverse_iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
-         bool operator==(const reverse_iterator &other) const { return other._base == this->_base && other._iter == this->_iter; }
-         bool operator!=(const reverse_iterator &other) const { return !(*this == other); }
-         reverse_iterator::reference operator*() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to dereference an iterator on a null pointer");
-
-            return *this->_iter;
+            if (new_ptr == nullptr)
+               throw std::bad_alloc();
          }
-         reverse_iterator::pointer operator->() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to dereference an iterator on a null pointer");
+         else if constexpr (uses_system_heap)
+         {
+            new_ptr = static_cast<std::uint8_t *>(std::realloc(old_ptr, capacity));
 
-            return this->_iter;
+            if (new_ptr == nullptr)
+               throw std::bad_alloc();
          }
-      };
-      class const_reverse_iterator
-      {
-      public:
-         using iterator_category = std::forward_iterator_tag;
-         using difference_type = std::ptrdiff_t;
-         using value_type = const T;
-         using pointer = const_reverse_iterator::value_type *;
-         using reference = const_reverse_iterator::value_type &;
-
-      private:
-         const basic_ptr<T,TypeSize,TypeAlign,Allocator> *_base;
-         const_reverse_iterator::pointer _iter;
-
-      public:
-         const_reverse_iterator(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &base, bool end=false) : _base(&base) {
-            if (end)
-               this->_iter = base.reob();
-            else if (base.elements() > 0)
-               this->_iter = &base.back();
-            else
-               this->_iter = base.get();
+         else
+         {
+            new_ptr = this->allocator_allocate(capacity);
+            std::memcpy(new_ptr, old_ptr, std::min(this->_size, capacity));
+            this->allocator_deallocate(old_ptr, this->_capacity);
          }
 
-         const_reverse_iterator(const const_reverse_iterator &other) : _base(other._base), _iter(other._iter) {}
-         ~const_reverse_iterator() {}
+         instrument::record<T>(instrument::event::reallocate, std::min(this->_size, capacity));
+         instrument::record_live<T>(static_cast<std::int64_t>(capacity) - static_cast<std::int64_t>(this->_capacity));
 
-         const_reverse_iterator &operator=(const const_reverse_iterator &other) {
-            this->_base = other._base;
-            this->_iter = other._iter;
+         this->_ptr = reinterpret_cast<pointer>(new_ptr);
+         this->_capacity = capacity;
 
-            return *this;
+         if (this->_size > capacity)
+            this->_size = capacity;
+      }
+      std::size_t grow_capacity(std::size_t required) const {
+         return std::max(required, this->capacity() * 2);
+      }
+      // Constructs a Value at the end of the buffer in a slot of slot_size bytes, growing the
+      // buffer geometrically when it is full, and returns the new slot.
+      template <typename Value, typename... Args>
+      Value *emplace_tail(std::size_t slot_size, Args&&... args) {
+         auto size = this->_size + slot_size;
+         Value *slot;
+
+         if (size > this->_capacity || !this->is_allocated())
+         {
+            // the arguments may refer to our own elements, so build the value before the buffer moves
+            Value value(std::forward<Args>(args)...);
+            this->reserve(this->grow_capacity(size));
+            slot = reinterpret_cast<Value *>(reinterpret_cast<std::uint8_t *>(this->_ptr) + this->_size);
+            new (slot) Value(std::move(value));
+         }
+         else
+         {
+            this->detach();
+            slot = reinterpret_cast<Value *>(reinterpret_cast<std::uint8_t *>(this->_ptr) + this->_size);
+            new (slot) Value(std::forward<Args>(args)...);
          }
-         const_reverse_iterator &operator++() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to advance an iterator on a null pointer");
 
-            auto uintptr_cast = reinterpret_cast<std::uintptr_t>(this->_iter);
-            auto size = this->_base->aligned_type_size();
+         this->_size = size;
 
-            this->_iter = reinterpret_cast<const_reverse_iterator::pointer>(uintptr_cast-size);
+         return slot;
+      }
+      // Copies bytes from ptr to the end of the buffer, growing it geometrically when it is full.
+      // ptr may point into the buffer itself.
+      void append_tail(const void *ptr, std::size_t bytes) {
+         auto offset = this->_size;
 
-            return *this;
+         if (offset + bytes > this->_capacity || !this->is_allocated())
+         {
+            auto base = reinterpret_cast<std::uintptr_t>(this->_ptr);
+            auto source = reinterpret_cast<std::uintptr_t>(ptr);
+            auto aliased = this->_ptr != nullptr && source >= base && source < base + offset;
+
+            this->reserve(this->grow_capacity(offset + bytes));
+
+            if (aliased)
+               ptr = reinterpret_cast<const void *>(reinterpret_cast<std::uintptr_t>(this->_ptr) + (source - base));
          }
-         const_reverse_iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
-         bool operator==(const const_reverse_iterator &other) const { return other._base == this->_base && other._iter == this->_iter; }
-         bool operator!=(const const_reverse_iterator &other) const { return !(*this == other); }
-         const_reverse_iterator::reference operator*() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to dereference an iterator on a null pointer");
-
-            return *this->_iter;
+         else
+            this->detach();
+
+         std::memmove(reinterpret_cast<std::uint8_t *>(this->_ptr) + offset, ptr, bytes);
+         this->_size = offset + bytes;
+      }
+      // Resizes to size bytes, growing the capacity to at least capacity bytes if it has to grow.
+      // Growth happens here rather than beforehand so that a lazily-zeroed mapping only clears
+      // the pages it had before growing.
+      void reallocate_to(std::size_t size, std::size_t capacity, allocation_mode mode) {
+         if (!this->is_allocated())
+         {
+            this->allocate(size, mode);
+            return;
          }
-         const_reverse_iterator::pointer operator->() {
-            if (this->_iter == nullptr)
-               throw std::runtime_error("null pointer: attempting to dereference an iterator on a null pointer");
+         
+         if (size == 0)
+            throw std::runtime_error("null allocation: cannot allocate a zero-sized buffer");
 
-            return this->_iter;
+         if (size < this->type_size)
+            throw std::runtime_error("insufficient size: the allocation size is not large enough to hold a single element");
+
+         if (size == this->size())
+            return;
+
+         auto old_capacity = this->_capacity;
+
+         if (size > this->_capacity)
+            this->reallocate_capacity(std::max(size, capacity));
+         else if (size > this->_size)
+            this->detach();
+
+         if (size > this->_size && mode != allocation_mode::uninitialized)
+         {
+            auto zero_end = size;
+
+            // pages a mapping grew by come from the kernel already zeroed
+            if (mode == allocation_mode::lazily_zeroed && this->_mapped)
+               zero_end = std::min(size, align(old_capacity, page_size()));
+
+            if (zero_end > this->_size)
+               std::memset(reinterpret_cast<std::uint8_t *>(this->_ptr)+this->_size, 0, zero_end - this->_size);
          }
-      };
 
-      basic_ptr(bool allocate=false) : _ptr(static_cast<pointer>(nullptr)), _size(0), _allocator(std::nullopt) {
+         this->_size = size;
+      }
+
+      template <std::size_t LocalTypeSize, std::size_t LocalTypeAlign>
+      std::uintptr_t address_at(const_pointer ptr, std::size_t offset, bool aligned) const {
+         CheckPolicy::check(ptr != nullptr, "null pointer: attempting to access a null pointer");
+         CheckPolicy::check(!aligned || offset % this->type_align == 0, "alignment error: the given offset is not aligned to the type boundary");
+         CheckPolicy::check(offset + align(LocalTypeSize, LocalTypeAlign) <= this->size(), "out of bounds: the given offset exceeds the allocation boundary");
+
+         return reinterpret_cast<std::uintptr_t>(ptr) + offset;
+      }
+      pointer end_element() {
+         auto ptr = this->get();
+
+         if (ptr == nullptr)
+            return ptr;
+
+         return reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(ptr) + this->elements() * this->type_stride);
+      }
+      const_pointer end_element() const {
+         auto ptr = this->get();
+
+         if (ptr == nullptr)
+            return ptr;
+
+         return reinterpret_cast<const_pointer>(reinterpret_cast<std::uintptr_t>(ptr) + this->elements() * this->type_stride);
+      }
+      pointer last_element() {
+         if (this->is_null())
+            return this->get();
+
+         return reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(this->end_element()) - this->type_stride);
+      }
+      const_pointer last_element() const {
+         if (this->is_null())
+            return this->get();
+
+         return reinterpret_cast<const_pointer>(reinterpret_cast<std::uintptr_t>(this->end_element()) - this->type_stride);
+      }
+
+   public:
+      using iterator = basic_iterator<T,type_stride,CheckPolicy,false>;
+      using const_iterator = basic_iterator<const T,type_stride,CheckPolicy,false>;
+      using reverse_iterator = basic_iterator<T,type_stride,CheckPolicy,true>;
+      using const_reverse_iterator = basic_iterator<const T,type_stride,CheckPolicy,true>;
+
+      basic_ptr(bool allocate=false) : _ptr(nullptr), _const(false), _size(0) {
          if (allocate)
             this->allocate(this->type_size);
       }
-      basic_ptr(std::size_t size) : _ptr(static_cast<pointer>(nullptr)), _size(0), _allocator(std::nullopt) {
+      basic_ptr(std::size_t size, allocation_mode mode=allocation_mode::zeroed) : _ptr(nullptr), _const(false), _size(0) {
          if (size > 0)
-            this->allocate(size);
+            this->allocate(size, mode);
+      }
+      basic_ptr(const Allocator &allocator) : _ptr(nullptr), _const(false), _size(0), _allocator(allocator) {}
+      basic_ptr(std::size_t size, const Allocator &allocator, allocation_mode mode=allocation_mode::zeroed)
+         : _ptr(nullptr), _const(false), _size(0), _allocator(allocator)
+      {
+         if (size > 0)
+            this->allocate(size, mode);
       }
       basic_ptr(pointer ptr, std::size_t size=TypeSize, bool clone=false) {
          if (clone)
@@ -293,76 +479,94 @@ namespace ptrtools
          else
             this->set(ptr, size);
       }
-      basic_ptr(basic_ptr<T,TypeSize,TypeAlign,Allocator> &other) {
-         if (other.is_allocated())
-         {
-            if (this->is_allocated())
-               this->deallocate();
-         
-            this->_allocator = other._allocator;
+      basic_ptr(basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other)
+         : _allocator(allocator_traits::select_on_container_copy_construction(other._allocator))
+      {
+         if (other.is_shared() && this->_allocator == other._allocator)
+            this->share_with(other);
+         else if (other.is_allocated())
             this->clone(other);
-         }
          else
-            this->set(other.get(), other.size());
-      }
-      basic_ptr(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &other) {
-         if (other.is_allocated())
          {
-            if (this->is_allocated())
-               this->deallocate();
-         
-            this->_allocator = other._allocator;
-            this->clone(other);
+            this->set(other._ptr, other.size());
+            this->_const = other._const;
          }
+      }
+      basic_ptr(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other)
+         : _allocator(allocator_traits::select_on_container_copy_construction(other._allocator))
+      {
+         if (other.is_shared() && this->_allocator == other._allocator)
+            this->share_with(other);
+         else if (other.is_allocated())
+            this->clone(other);
          else
             this->set(other.get(), other.size());
       }
-      basic_ptr(basic_ptr<T,TypeSize,TypeAlign,Allocator> &&other) {
-         this->_ptr = std::move(other._ptr);
-         this->_size = std::move(other._size);
-         this->_allocator = std::move(other._allocator);
+      basic_ptr(basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &&other) : _allocator(std::move(other._allocator)) {
+         this->take(other);
       }
       virtual ~basic_ptr() {
          if (this->is_allocated())
             this->deallocate();
       }
 
-      basic_ptr<T,TypeSize,TypeAlign,Allocator> &operator=(basic_ptr<T,TypeSize,TypeAlign,Allocator> &other) {
-         if (other.is_allocated())
-         {
-            if (this->is_allocated())
-               this->deallocate();
-         
-            this->_allocator = other._allocator;
+      basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &operator=(basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) {
+         if (this == &other)
+            return *this;
+
+         this->propagate_copy(other);
+
+         if (other.is_shared() && this->_allocator == other._allocator)
+            this->share_with(other);
+         else if (other.is_allocated())
             this->clone(other);
-         }
          else
-            this->set(other.get(), other.size());
+         {
+            this->set(other._ptr, other.size());
+            this->_const = other._const;
+         }
 
          return *this;
       }
-      basic_ptr<T,TypeSize,TypeAlign,Allocator> &operator=(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &other) {
-         if (other.is_allocated())
-         {
-            if (this->is_allocated())
-               this->deallocate();
-         
-            this->_allocator = other._allocator;
+      basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &operator=(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) {
+         if (this == &other)
+            return *this;
+
+         this->propagate_copy(other);
+
+         if (other.is_shared() && this->_allocator == other._allocator)
+            this->share_with(other);
+         else if (other.is_allocated())
             this->clone(other);
-         }
          else
             this->set(other.get(), other.size());
 
          return *this;
       }
-      basic_ptr<T,TypeSize,TypeAlign,Allocator> &operator=(basic_ptr<T,TypeSize,TypeAlign,Allocator> &&other) {
-         this->_ptr = std::move(other._ptr);
-         this->_size = std::move(other._size);
-         this->_allocator = std::move(other._allocator);
+      basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &operator=(basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &&other) {
+         if (this == &other)
+            return *this;
+
+         if (this->is_allocated())
+            this->deallocate();
+
+         if constexpr (allocator_traits::propagate_on_container_move_assignment::value)
+         {
+            this->_allocator = std::move(other._allocator);
+            this->take(other);
+         }
+         else if (!other.is_allocated() || this->_allocator == other._allocator)
+            this->take(other);
+         else
+         {
+            // the block belongs to an allocator we may not adopt, so copy it into our own
+            this->clone(other);
+            other.deallocate();
+         }
 
          return *this;
       }
-      bool operator<(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &other) const {
+      bool operator<(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) const {
          if (this->get() == other.get() && this->size() == other.size() && this->is_allocated() == other.is_allocated())
             return false;
 
@@ -374,10 +578,10 @@ namespace ptrtools
 
          return static_cast<std::uint8_t>(this->is_allocated()) < static_cast<std::uint8_t>(other.is_allocated());
       }
-      bool operator==(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &other) const {
+      bool operator==(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) const {
          return !(*this < other) && !(other < *this);
       }
-      bool operator!=(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &other) const {
+      bool operator!=(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) const {
          return !(*this == other);
       }
       reference operator[](std::size_t pos) { return this->at(pos); }
@@ -385,32 +589,52 @@ namespace ptrtools
       reference operator*() {
          auto ptr = this->get();
 
-         if (ptr == nullptr)
-            throw std::runtime_error("null pointer: attempting to dereference a null pointer");
+         CheckPolicy::check(ptr != nullptr, "null pointer: attempting to dereference a null pointer");
          
          return *ptr;
       }
       const_reference operator*() const {
          auto ptr = this->get();
 
-         if (ptr == nullptr)
-            throw std::runtime_error("null pointer: attempting to dereference a null pointer");
+         CheckPolicy::check(ptr != nullptr, "null pointer: attempting to dereference a null pointer");
          
          return *ptr;
       }
       pointer operator->() { return &**this; }
       const_pointer operator->() const { return &**this; }
 
-      bool is_const() const { return std::get_if<const_pointer>(&this->_ptr) != nullptr; }
-      bool is_allocated() const { return this->_allocator.has_value(); }
-      bool is_null() const {
-         if (auto mut = std::get_if<pointer>(&this->_ptr))
-            return *mut == nullptr;
-         else
-            return std::get<const_pointer>(this->_ptr) == nullptr;
+      allocator get_allocator() const { return this->_allocator; }
+
+      bool is_const() const { return this->_const; }
+      bool is_allocated() const { return this->_allocated; }
+      bool is_null() const { return this->_ptr == nullptr; }
+      bool is_shared() const { return copy_on_write && this->_shared != nullptr; }
+      std::size_t use_count() const {
+         if (this->_shared != nullptr)
+            return this->_shared->count.load(std::memory_order_acquire);
+
+         return this->is_allocated() ? 1 : 0;
+      }
+
+      // Copy-on-write: once an allocated pointer is shared, copies made with the same allocator
+      // reference its buffer instead of cloning it. The first mutable access through any owner
+      // while others remain gives that owner a private copy, so readers never see a write. Only
+      // pointers with a copy_on_write_policy can share; the others keep a branch-free get().
+      void share() {
+         static_assert(copy_on_write, "Sharing requires a copy_on_write_policy check policy");
+
+         if (!this->is_allocated())
+            throw std::runtime_error("invalid argument: only allocated pointers can be shared");
+
+         if (this->_shared == nullptr)
+            this->_shared = this->create_shared();
+      }
+      void detach() {
+         if (this->shared_elsewhere())
+            this->unshare(this->_capacity);
       }
 
-      void allocate(std::size_t size) {
+      void allocate(std::size_t size, allocation_mode mode=allocation_mode::zeroed) {
          if (size == 0)
             throw std::runtime_error("null allocation: cannot allocate a zero-sized buffer");
 
@@ -420,47 +644,81 @@ namespace ptrtools
          if (this->is_allocated())
             this->deallocate();
 
-         this->_allocator = Allocator();
-         this->_ptr = reinterpret_cast<pointer>(this->_allocator->allocate(size));
-         std::memset(std::get<pointer>(this->_ptr), 0, size);
-         
+         this->_ptr = reinterpret_cast<pointer>(this->heap_allocate(size, mode));
+         this->_const = false;
+         this->_allocated = true;
+
          this->_size = size;
+         this->_capacity = size;
+      }
+      void allocate(std::size_t size, const Allocator &allocator, allocation_mode mode=allocation_mode::zeroed) {
+         if (size == 0)
+            throw std::runtime_error("null allocation: cannot allocate a zero-sized buffer");
+
+         // copy the allocator and allocate on the side, so that a failure leaves this pointer as it was
+         basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> replacement(size, allocator, mode);
+
+         if (this->is_allocated())
+            this->deallocate();
+
+         if constexpr (std::is_move_assignable<Allocator>::value)
+            this->_allocator = std::move(replacement._allocator);
+         else
+         {
+            // polymorphic_allocator and friends are not assignable, so rebuild the instance in
+            // place; allocators may not throw when moved
+            this->_allocator.~Allocator();
+            new (&this->_allocator) Allocator(std::move(replacement._allocator));
+         }
+
+         this->take(replacement);
       }
       void deallocate() {
          if (!this->is_allocated())
             throw std::runtime_error("invalid deallocation: attempting to release a pointer that is not allocated");
 
-         this->_allocator->deallocate(reinterpret_cast<std::uint8_t *>(this->get()), this->size());
-         this->_allocator = std::nullopt;
-         this->_ptr = static_cast<pointer>(nullptr);
+         if (copy_on_write && this->_shared != nullptr)
+         {
+            this->release_shared(this->_shared, reinterpret_cast<std::uint8_t *>(this->_ptr), this->_capacity, this->_mapped);
+            this->_shared = nullptr;
+            this->_mapped = false;
+         }
+         else
+            this->heap_deallocate(reinterpret_cast<std::uint8_t *>(this->_ptr), this->_capacity);
+
+         this->_allocated = false;
+         this->_ptr = nullptr;
+         this->_const = false;
          this->_size = 0;
+         this->_capacity = 0;
+      }
+      void reallocate(std::size_t size, allocation_mode mode=allocation_mode::zeroed) {
+         this->reallocate_to(size, size, mode);
       }
-      void reallocate(std::size_t size) {
+      void reserve(std::size_t capacity) {
          if (!this->is_allocated())
          {
-            this->allocate(size);
-            return;
-         }
-         
-         if (size == 0)
-            throw std::runtime_error("null allocation: cannot allocate a zero-sized buffer");
+            auto old_ptr = this->_ptr;
+            auto old_size = this->size();
 
-         if (size < this->type_size)
-            throw std::runtime_error("insufficient size: the allocation size is not large enough to hold a single element");
+            this->_ptr = reinterpret_cast<pointer>(this->heap_allocate(std::max(capacity, old_size), allocation_mode::uninitialized));
+            this->_const = false;
+            this->_allocated = true;
+            this->_capacity = std::max(capacity, old_size);
+            this->_size = old_size;
+
+            if (old_ptr != nullptr && old_size > 0)
+               std::memcpy(this->_ptr, old_ptr, old_size);
 
-         if (size == this->size())
             return;
-                  
-         auto new_ptr = this->_allocator->allocate(size);
-         std::memset(new_ptr, 0, size);
+         }
          
-         auto old_ptr = this->get();
-         auto copy_size = std::min(size, this->size());
-         std::memcpy(new_ptr, old_ptr, copy_size);
-
-         this->_allocator->deallocate(reinterpret_cast<std::uint8_t *>(old_ptr), this->size());
-         this->_size = size;
-         this->_ptr = reinterpret_cast<pointer>(new_ptr);
+         if (capacity > this->_capacity)
+            this->reallocate_capacity(capacity);
+      }
+      void shrink_to_fit() {
+         if (this->is_allocated() && this->_capacity > this->_size)
+            this->reallocate_capacity(this->_size);
       }
       void resize(std::size_t size) {
          if (this->is_allocated())
@@ -480,29 +738,29 @@ namespace ptrtools
             this->deallocate();
 
          this->_ptr = ptr;
+         this->_const = false;
          this->_size = size;
-         this->_allocator = std::nullopt;
       }
       void set(const_pointer ptr, std::size_t size) {
          if (this->is_allocated())
             this->deallocate();
 
-         this->_ptr = ptr;
+         this->_ptr = const_cast<pointer>(ptr);
+         this->_const = true;
          this->_size = size;
-         this->_allocator = std::nullopt;
       }
       pointer get() {
-         if (auto mut = std::get_if<pointer>(&this->_ptr))
-            return *mut;
-         else
-            throw std::runtime_error("const conflict: attempting to get a mutable pointer from a const pointer");
-      }
-      const_pointer get() const {
-         if (auto mut = std::get_if<pointer>(&this->_ptr))
-            return const_cast<const_pointer>(*mut);
-         else
-            return std::get<const_pointer>(this->_ptr);
+         CheckPolicy::check(!this->_const, "const conflict: attempting to get a mutable pointer from a const pointer");
+
+         if constexpr (copy_on_write)
+         {
+            if (this->_shared != nullptr)
+               this->detach();
+         }
+
+         return this->_ptr;
       }
+      const_pointer get() const { return this->_ptr; }
       pointer eob() {
          auto ptr = this->get();
 
@@ -549,80 +807,89 @@ namespace ptrtools
       }
 
       std::size_t size() const { return this->_size; }
-      std::size_t aligned_type_size() const { return align(this->type_size, this->type_align); }
+      std::size_t capacity() const { return this->is_allocated() ? this->_capacity : this->_size; }
+      std::size_t aligned_type_size() const { return this->type_stride; }
       std::size_t elements() const { return this->size() / this->aligned_type_size(); }
       reference front() { return (*this)[0]; }
       const_reference front() const { return (*this)[0]; }
       reference back() { return (*this)[this->elements()-1]; }
       const_reference back() const { return (*this)[this->elements()-1]; }
 
-      iterator begin() { return iterator(*this); }
-      const_iterator cbegin() const { return const_iterator(*this); }
-      reverse_iterator rbegin() { return reverse_iterator(*this); }
-      const_reverse_iterator crbegin() const { return const_reverse_iterator(*this); }
-      iterator end() { return iterator(*this, true); }
-      const_iterator cend() const { return const_iterator(*this, true); }
-      reverse_iterator rend() { return reverse_iterator(*this, true); }
-      const_reverse_iterator crend() const { return const_reverse_iterator(*this, true); }
+      iterator begin() { return iterator(this->get()); }
+      const_iterator begin() const { return this->cbegin(); }
+      const_iterator cbegin() const { return const_iterator(this->get()); }
+      reverse_iterator rbegin() { return reverse_iterator(this->last_element()); }
+      const_reverse_iterator rbegin() const { return this->crbegin(); }
+      const_reverse_iterator crbegin() const { return const_reverse_iterator(this->last_element()); }
+      iterator end() { return iterator(this->end_element()); }
+      const_iterator end() const { return this->cend(); }
+      const_iterator cend() const { return const_iterator(this->end_element()); }
+      reverse_iterator rend() { return reverse_iterator(this->reob()); }
+      const_reverse_iterator rend() const { return this->crend(); }
+      const_reverse_iterator crend() const { return const_reverse_iterator(this->reob()); }
       
       std::size_t offset(std::size_t index) const {
          auto aligned_offset = this->aligned_type_size() * index;
 
-         if (aligned_offset >= this->size())
-            std::runtime_error("out of bounds: the given index goes out of bounds of the aligned pointer allocation");
+         CheckPolicy::check(aligned_offset < this->size(), "out of bounds: the given index goes out of bounds of the aligned pointer allocation");
 
          return aligned_offset;
       }
       std::size_t index(std::size_t offset) const {
-         if (offset >= this->size())
-            std::runtime_error("out of bounds: the given offset goes out of bounds of the allocation");
+         CheckPolicy::check(offset < this->size(), "out of bounds: the given offset goes out of bounds of the allocation");
 
          return offset / this->aligned_type_size();
       }
 
       template <typename U=T, std::size_t LocalTypeSize=sizeof(U), std::size_t LocalTypeAlign=alignof(U)>
-      basic_ptr<U,LocalTypeSize,LocalTypeAlign,Allocator> ptr_at(std::size_t offset, bool aligned=true) {
-         auto ptr = this->get();
-
-         if (ptr == nullptr)
-            throw std::runtime_error("null pointer: attempting to access a null pointer");
-
-         if (aligned && offset % this->type_align != 0)
-            throw std::runtime_error("alignment error: the given offset is not aligned to the type boundary");
+      basic_ptr<U,LocalTypeSize,LocalTypeAlign,Allocator,CheckPolicy> ptr_at(std::size_t offset, bool aligned=true) {
+         auto address = this->template address_at<LocalTypeSize,LocalTypeAlign>(this->get(), offset, aligned);
          
-         auto uintptr_cast = reinterpret_cast<std::uintptr_t>(ptr);
-         auto aligned_size = align(LocalTypeSize, LocalTypeAlign);
-         auto end = offset + aligned_size;
-
-         if (end > this->size())
-            throw std::runtime_error("out of bounds: the given offset exceeds the allocation boundary");
+         return basic_ptr<U,LocalTypeSize,LocalTypeAlign,Allocator,CheckPolicy>(reinterpret_cast<U*>(address), align(LocalTypeSize, LocalTypeAlign));
+      }
+      template <typename U=T, std::size_t LocalTypeSize=sizeof(U), std::size_t LocalTypeAlign=alignof(U)>
+      const basic_ptr<U,LocalTypeSize,LocalTypeAlign,Allocator,CheckPolicy> ptr_at(std::size_t offset, bool aligned=true) const {
+         auto address = this->template address_at<LocalTypeSize,LocalTypeAlign>(this->get(), offset, aligned);
 
-         return basic_ptr<U,LocalTypeSize,LocalTypeAlign,Allocator>(reinterpret_cast<U*>(uintptr_cast+offset), aligned_size);
+         return basic_ptr<U,LocalTypeSize,LocalTypeAlign,Allocator,CheckPolicy>(reinterpret_cast<const U*>(address), align(LocalTypeSize, LocalTypeAlign));
       }
       template <typename U=T, std::size_t LocalTypeSize=sizeof(U), std::size_t LocalTypeAlign=alignof(U)>
-      const basic_ptr<U,LocalTypeSize,LocalTypeAlign,Allocator> ptr_at(std::size_t offset, bool aligned=true) const {
-         auto ptr = this->get();
+      element_handle<U,CheckPolicy> handle_at(std::size_t offset, bool aligned=true) {
+         auto address = this->template address_at<LocalTypeSize,LocalTypeAlign>(this->get(), offset, aligned);
 
-         if (ptr == nullptr)
-            throw std::runtime_error("null pointer: attempting to access a null pointer");
+         return element_handle<U,CheckPolicy>(reinterpret_cast<U*>(address));
+      }
+      template <typename U=T, std::size_t LocalTypeSize=sizeof(U), std::size_t LocalTypeAlign=alignof(U)>
+      element_handle<const U,CheckPolicy> handle_at(std::size_t offset, bool aligned=true) const {
+         auto address = this->template address_at<LocalTypeSize,LocalTypeAlign>(this->get(), offset, aligned);
 
-         if (aligned && offset % this->type_align != 0)
-            throw std::runtime_error("alignment error: the given offset is not aligned to the type boundary");
-         
-         auto uintptr_cast = reinterpret_cast<std::uintptr_t>(ptr);
-         auto aligned_size = align(LocalTypeSize, LocalTypeAlign);
-         auto end = offset + aligned_size;
+         return element_handle<const U,CheckPolicy>(reinterpret_cast<const U*>(address));
+      }
+      template <typename U=T, std::size_t LocalTypeSize=sizeof(U), std::size_t LocalTypeAlign=alignof(U)>
+      basic_view<U,LocalTypeSize,LocalTypeAlign,CheckPolicy> view_at(std::size_t offset, bool aligned=true) {
+         auto address = this->template address_at<LocalTypeSize,LocalTypeAlign>(this->get(), offset, aligned);
 
-         if (end > this->size())
-            throw std::runtime_error("out of bounds: the given offset exceeds the allocation boundary");
+         return basic_view<U,LocalTypeSize,LocalTypeAlign,CheckPolicy>(reinterpret_cast<U*>(address), align(LocalTypeSize, LocalTypeAlign));
+      }
+      template <typename U=T, std::size_t LocalTypeSize=sizeof(U), std::size_t LocalTypeAlign=alignof(U)>
+      basic_view<const U,LocalTypeSize,LocalTypeAlign,CheckPolicy> view_at(std::size_t offset, bool aligned=true) const {
+         auto address = this->template address_at<LocalTypeSize,LocalTypeAlign>(this->get(), offset, aligned);
 
-         return basic_ptr<U,LocalTypeSize,LocalTypeAlign,Allocator>(reinterpret_cast<const U*>(uintptr_cast+offset), aligned_size);
+         return basic_view<const U,LocalTypeSize,LocalTypeAlign,CheckPolicy>(reinterpret_cast<const U*>(address), align(LocalTypeSize, LocalTypeAlign));
       }
+      view_type view() { return view_type(this->get(), this->size()); }
+      const_view_type view() const { return const_view_type(this->get(), this->size()); }
+      view_type slice(std::size_t offset, std::size_t size) { return this->view().slice(offset, size); }
+      const_view_type slice(std::size_t offset, std::size_t size) const { return this->view().slice(offset, size); }
       reference at(std::size_t index) {
-         return *this->ptr_at<T,TypeSize,TypeAlign>(this->offset(index));
+         auto address = this->template address_at<TypeSize,TypeAlign>(this->get(), this->offset(index), true);
+
+         return *reinterpret_cast<pointer>(address);
       }
       const_reference at(std::size_t index) const {
-         return *this->ptr_at<T,TypeSize,TypeAlign>(this->offset(index));
+         auto address = this->template address_at<TypeSize,TypeAlign>(this->get(), this->offset(index), true);
+
+         return *reinterpret_cast<const_pointer>(address);
       }
       void assign(std::size_t index, const_reference value) {
          this->at(index) = value;
@@ -632,35 +899,86 @@ namespace ptrtools
          if (this->is_allocated())
             throw std::runtime_error("invalid argument: an allocated pointer cannot be consumed");
 
+         instrument::record<T>(instrument::event::consume, this->size());
          this->clone(this->get(), this->size());
       }
       void clone(const_pointer ptr, std::size_t size) {
-         this->allocate(size);
-         this->copy(ptr, size);
+         this->allocate(size, allocation_mode::uninitialized);
+         std::memcpy(this->_ptr, ptr, size);
+         instrument::record<T>(instrument::event::clone, size);
       }
-      void clone(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &other) {
+      void clone(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other) {
          this->clone(other.get(), other.size());
       }
       void copy(const_pointer ptr, std::size_t size, std::size_t offset=0, bool aligned=true) {
          auto local_ptr = this->get();
 
-         if (local_ptr == nullptr)
-            throw std::runtime_error("null pointer: attempting to copy to a null pointer");
-
-         if (aligned && offset % this->type_align != 0)
-            throw std::runtime_error("invalid alignment: alignment enforcement is set but the offset is not aligned");
+         CheckPolicy::check(local_ptr != nullptr, "null pointer: attempting to copy to a null pointer");
+         CheckPolicy::check(!aligned || offset % this->type_align == 0, "invalid alignment: alignment enforcement is set but the offset is not aligned");
          
          auto end = offset + size;
 
-         if (end > this->size())
-            throw std::runtime_error("out of bounds: copy of other pointer exceeds current allocation, try reallocating or cloning");
+         CheckPolicy::check(end <= this->size(), "out of bounds: copy of other pointer exceeds current allocation, try reallocating or cloning");
 
          auto uintptr_cast = reinterpret_cast<std::uintptr_t>(local_ptr);
          std::memcpy(reinterpret_cast<pointer>(uintptr_cast+offset), ptr, size);
+         instrument::record<T>(instrument::event::copy, size);
       }
-      void copy(const basic_ptr<T,TypeSize,TypeAlign,Allocator> &other, std::size_t offset=0, bool aligned=true) {
+      void copy(const basic_ptr<T,TypeSize,TypeAlign,Allocator,CheckPolicy> &other, std::size_t offset=0, bool aligned=true) {
          this->copy(other.get(), other.size(), offset, aligned);
       }
+
+      template <typename U=T, typename = typename std::enable_if<sizeof(U) == 1 && TypeSize == 1>::type>
+      std::size_t find_bytes(std::string_view pattern, std::size_t start=0) const {
+         if (pattern.empty())
+            throw std::runtime_error("invalid pattern: search patterns cannot be empty");
+
+         auto result = simd::find_bytes(reinterpret_cast<const std::uint8_t *>(this->get()), this->size(), start, reinterpret_cast<const std::uint8_t *>(pattern.data()), pattern.size());
+
+         return result == this->size() ? npos : result;
+      }
+      template <typename U=T, typename = typename std::enable_if<sizeof(U) == 1 && TypeSize == 1>::type>
+      std::vector<std::size_t> find_all(std::string_view pattern) const {
+         std::vector<std::size_t> result;
+
+         for (auto offset=this->find_bytes(pattern); offset != npos; offset=this->find_bytes(pattern, offset + pattern.size()))
+            result.push_back(offset);
+
+         return result;
+      }
+      template <typename U=T, typename = typename std::enable_if<sizeof(U) == 1 && TypeSize == 1>::type>
+      byte_match find_any(const byte_patterns &patterns, std::size_t start=0) const {
+         auto result = patterns.find(reinterpret_cast<const std::uint8_t *>(this->get()), this->size(), start);
+
+         if (result.offset == this->size())
+            return byte_match{npos, npos};
+
+         return result;
+      }
+      template <typename U=T, typename = typename std::enable_if<sizeof(U) == 1 && TypeSize == 1>::type>
+      std::vector<byte_match> find_all(const byte_patterns &patterns) const {
+         std::vector<byte_match> result;
+
+         for (auto match=this->find_any(patterns); match.offset != npos; match=this->find_any(patterns, match.offset + patterns.pattern(match.pattern).size()))
+            result.push_back(match);
+
+         return result;
+      }
+      template <typename U=T, typename = typename std::enable_if<sizeof(U) == 1 && TypeSize == 1>::type>
+      std::vector<const_view_type> split_on(std::string_view delimiter) const {
+         std::vector<const_view_type> result;
+         std::size_t start = 0;
+
+         for (auto offset : this->find_all(delimiter))
+         {
+            result.push_back(const_view_type(this->get() + start, offset - start));
+            start = offset + delimiter.size();
+         }
+
+         result.push_back(const_view_type(this->get() + start, this->size() - start));
+
+         return result;
+      }
    };
 }
 
@@ -0,0 +1,249 @@
+#ifndef __PTRTOOLS_CACHING_HPP
+#define __PTRTOOLS_CACHING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <ptrtools/memory.hpp>
+
+namespace ptrtools
+{
+   // Size-class block pool shared by every caching_allocator. Each thread keeps a free list per
+   // power-of-two size class and only touches the global pool, under a per-class lock, to move a
+   // whole batch of blocks at a time. A thread's cached blocks go back to the global pool when the
+   // thread exits. Requests above max_class_size bypass the pool entirely.
+   class caching_pool
+   {
+   public:
+      const static std::size_t min_class_size = 16;
+      const static std::size_t max_class_size = 32768;
+      const static std::size_t size_classes = 12;
+
+   private:
+      struct free_block
+      {
+         free_block *next;
+      };
+      struct free_list
+      {
+         free_block *head = nullptr;
+         std::size_t count = 0;
+      };
+      struct thread_cache
+      {
+         free_list lists[size_classes];
+
+         ~thread_cache() {
+            for (std::size_t index=0; index<size_classes; ++index)
+               if (this->lists[index].head != nullptr)
+                  caching_pool::global().release(index, this->lists[index]);
+
+            caching_pool::cache_destroyed() = true;
+         }
+      };
+
+      std::mutex _mutexes[size_classes];
+      std::vector<free_list> _lists[size_classes];
+      std::mutex _slab_mutex;
+      std::vector<void *> _slabs;
+
+      caching_pool() {}
+
+      static bool &cache_destroyed() {
+         thread_local bool destroyed = false;
+         return destroyed;
+      }
+      static thread_cache &local() {
+         thread_local thread_cache cache;
+         return cache;
+      }
+
+      free_list fetch(std::size_t index) {
+         std::lock_guard<std::mutex> lock(this->_mutexes[index]);
+
+         if (!this->_lists[index].empty())
+         {
+            auto result = this->_lists[index].back();
+            this->_lists[index].pop_back();
+            return result;
+         }
+
+         auto block_size = class_size(index);
+         auto blocks = batch_size(index);
+         auto slab = static_cast<std::uint8_t *>(::operator new(block_size * blocks));
+         free_list result;
+
+         {
+            std::lock_guard<std::mutex> slab_lock(this->_slab_mutex);
+            this->_slabs.push_back(slab);
+         }
+
+         for (std::size_t i=blocks; i>0; --i)
+         {
+            auto block = reinterpret_cast<free_block *>(slab + (i-1) * block_size);
+            block->next = result.head;
+            result.head = block;
+         }
+
+         result.count = blocks;
+
+         return result;
+      }
+      void release(std::size_t index, free_list list) {
+         std::lock_guard<std::mutex> lock(this->_mutexes[index]);
+
+         this->_lists[index].push_back(list);
+      }
+
+   public:
+      caching_pool(const caching_pool &other) = delete;
+      caching_pool &operator=(const caching_pool &other) = delete;
+
+      static caching_pool &global() {
+         // never destroyed: thread caches may still hand blocks back while statics are torn down
+         static caching_pool *pool = new caching_pool();
+         return *pool;
+      }
+
+      static std::size_t size_class(std::size_t size) {
+         if (size <= min_class_size)
+            return 0;
+
+#if defined(__GNUC__) || defined(__clang__)
+         return static_cast<std::size_t>(64 - __builtin_clzll(static_cast<unsigned long long>(size - 1))) - 4;
+#else
+         std::size_t index = 0;
+
+         for (std::size_t boundary=min_class_size; boundary<size; boundary<<=1)
+            ++index;
+
+         return index;
+#endif
+      }
+      static std::size_t class_size(std::size_t index) { return min_class_size << index; }
+      static std::size_t batch_size(std::size_t index) {
+         auto blocks = (64 * 1024) / class_size(index);
+
+         if (blocks < 8)
+            return 8;
+         else if (blocks > 256)
+            return 256;
+
+         return blocks;
+      }
+
+      static void *allocate(std::size_t size) {
+         if (size > max_class_size)
+            return ::operator new(size);
+
+         auto index = size_class(size);
+
+         if (cache_destroyed())
+         {
+            auto list = global().fetch(index);
+            auto block = list.head;
+
+            if (list.head->next != nullptr)
+               global().release(index, free_list{list.head->next, list.count-1});
+
+            return block;
+         }
+
+         auto &list = local().lists[index];
+
+         if (list.head == nullptr)
+            list = global().fetch(index);
+
+         auto block = list.head;
+         list.head = block->next;
+         --list.count;
+
+         return block;
+      }
+      static void deallocate(void *ptr, std::size_t size) {
+         if (size > max_class_size)
+         {
+            ::operator delete(ptr);
+            return;
+         }
+
+         auto index = size_class(size);
+         auto block = static_cast<free_block *>(ptr);
+
+         if (cache_destroyed())
+         {
+            block->next = nullptr;
+            global().release(index, free_list{block, 1});
+            return;
+         }
+
+         auto &list = local().lists[index];
+         auto batch = batch_size(index);
+
+         block->next = list.head;
+         list.head = block;
+         ++list.count;
+
+         if (list.count < batch * 2)
+            return;
+
+         // keep one batch for this thread and hand the other back to the shared pool
+         free_list spill{list.head, batch};
+         auto tail = list.head;
+
+         for (std::size_t i=1; i<batch; ++i)
+            tail = tail->next;
+
+         list.head = tail->next;
+         list.count -= batch;
+         tail->next = nullptr;
+
+         global().release(index, spill);
+      }
+   };
+
+   // Stateless allocator over caching_pool, for churn-heavy basic_ptr objects that keep cloning
+   // and releasing blocks of the same few sizes. Pool blocks carry operator new's default
+   // alignment; over-aligned types bypass the pool.
+   template <typename T=std::uint8_t>
+   class caching_allocator
+   {
+   public:
+      using value_type = T;
+      using propagate_on_container_move_assignment = std::true_type;
+      using is_always_equal = std::true_type;
+
+      const static std::size_t alignment = alignof(T) > default_new_alignment ? alignof(T) : default_new_alignment;
+
+      template <typename U>
+      struct rebind { using other = caching_allocator<U>; };
+
+      caching_allocator() {}
+      template <typename U>
+      caching_allocator(const caching_allocator<U> &other) { (void)other; }
+
+      template <typename U>
+      bool operator==(const caching_allocator<U> &other) const { (void)other; return true; }
+      template <typename U>
+      bool operator!=(const caching_allocator<U> &other) const { (void)other; return false; }
+
+      T *allocate(std::size_t n) {
+         if constexpr (alignof(T) > default_new_alignment)
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+         else
+            return static_cast<T *>(caching_pool::allocate(n * sizeof(T)));
+      }
+      void deallocate(T *ptr, std::size_t n) {
+         if constexpr (alignof(T) > default_new_alignment)
+            ::operator delete(ptr, std::align_val_t(alignof(T)));
+         else
+            caching_pool::deallocate(ptr, n * sizeof(T));
+      }
+   };
+}
+
+#endif
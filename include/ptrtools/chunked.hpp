@@ -0,0 +1,345 @@
+#ifndef __PTRTOOLS_CHUNKED_HPP
+#define __PTRTOOLS_CHUNKED_HPP
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ptrtools/array.hpp>
+#include <ptrtools/memory.hpp>
+#include <ptrtools/view.hpp>
+
+#ifdef PTRTOOLS_HAS_MMAP
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace ptrtools
+{
+   // Streams a file that is too big to map through a ring of pre-allocated array_ptr buffers. A
+   // background thread preads the next chunks while the caller works on the current one, so the
+   // disk and the processing stay busy at the same time. Every buffer keeps carry_capacity bytes
+   // free in front of its chunk: a record that straddles a chunk boundary is kept by calling
+   // carry(n) before next(), which copies the last n bytes of the current chunk in front of the
+   // next one instead of reallocating anything.
+   //
+   //    chunked_reader reader(path);
+   //    for (auto chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+   //       reader.carry(chunk.size() - parse_whole_records(chunk.bytes()));
+   class chunked_reader
+   {
+   public:
+      using view_type = basic_view<const std::uint8_t,1,1>;
+
+      // One chunk of the file, preceded by whatever the previous chunk carried over. It stays
+      // valid until the next call to next().
+      class chunk
+      {
+         view_type _bytes;
+         std::uint64_t _offset = 0;
+         std::size_t _carried = 0;
+         bool _last = true;
+
+      public:
+         chunk() {}
+         chunk(view_type bytes, std::uint64_t offset, std::size_t carried, bool last) : _bytes(bytes), _offset(offset), _carried(carried), _last(last) {}
+
+         view_type bytes() const { return this->_bytes; }
+         const std::uint8_t *data() const { return this->_bytes.get(); }
+         std::size_t size() const { return this->_bytes.size(); }
+         bool empty() const { return this->_bytes.size() == 0; }
+         // file offset of the first byte, carried bytes included
+         std::uint64_t offset() const { return this->_offset; }
+         std::size_t carried() const { return this->_carried; }
+         bool is_last() const { return this->_last; }
+      };
+
+      const static std::size_t default_chunk_size = 4 * 1024 * 1024;
+      const static std::size_t default_carry_capacity = 64 * 1024;
+
+   private:
+      struct slot
+      {
+         array_ptr<std::uint8_t> buffer;
+         std::size_t size = 0;
+         std::uint64_t offset = 0;
+         // the read that should have filled this slot failed
+         std::exception_ptr error;
+         bool ready = false;
+         bool last = false;
+      };
+
+      int _fd = -1;
+      bool _owns_fd = false;
+      std::uint64_t _file_size = 0;
+      std::size_t _chunk_size = 0;
+      std::size_t _carry_capacity = 0;
+      std::vector<slot> _slots;
+
+      // consumer state, only touched by the thread calling next()
+      std::size_t _consumed = 0;
+      std::size_t _current_size = 0;
+      std::size_t _carry = 0;
+      bool _holding = false;
+      bool _finished = false;
+
+      mutable std::mutex _mutex;
+      std::condition_variable _filled;
+      std::condition_variable _freed;
+      bool _stopping = false;
+      std::thread _thread;
+
+      std::uint8_t *chunk_start(slot &target) { return target.buffer.get() + this->_carry_capacity; }
+
+      std::size_t fill(slot &target, std::uint64_t offset) {
+         std::size_t filled = 0;
+
+#ifdef PTRTOOLS_HAS_MMAP
+         auto start = this->chunk_start(target);
+
+         while (filled < this->_chunk_size)
+         {
+            auto result = ::pread(this->_fd, start + filled, this->_chunk_size - filled, static_cast<off_t>(offset + filled));
+
+            if (result < 0)
+            {
+               if (errno == EINTR)
+                  continue;
+
+               throw std::runtime_error("I/O error: could not read the file");
+            }
+
+            if (result == 0)
+               break;
+
+            filled += static_cast<std::size_t>(result);
+         }
+#else
+         (void)target;
+         (void)offset;
+#endif
+
+         return filled;
+      }
+      void produce() {
+         std::uint64_t offset = 0;
+
+         for (std::size_t index=0;; ++index)
+         {
+            auto &target = this->_slots[index % this->_slots.size()];
+
+            {
+               std::unique_lock<std::mutex> lock(this->_mutex);
+               this->_freed.wait(lock, [&]() { return this->_stopping || !target.ready; });
+
+               if (this->_stopping)
+                  return;
+            }
+
+            std::size_t filled = 0;
+            std::exception_ptr error;
+
+            try
+            {
+               filled = this->fill(target, offset);
+            }
+            catch (...)
+            {
+               error = std::current_exception();
+            }
+
+            bool last = error != nullptr || filled < this->_chunk_size || offset + filled >= this->_file_size;
+
+            {
+               std::lock_guard<std::mutex> lock(this->_mutex);
+
+               target.size = filled;
+               target.offset = offset;
+               target.last = last;
+               target.error = error;
+               target.ready = true;
+            }
+
+            this->_filled.notify_one();
+
+            if (last)
+               return;
+
+            offset += filled;
+         }
+      }
+
+      void start(std::size_t buffers) {
+         if (this->_chunk_size == 0)
+            throw std::runtime_error("invalid argument: the chunk size cannot be zero");
+
+         // the caller holds one buffer while the reader fills the others
+         if (buffers < 2)
+            throw std::runtime_error("invalid argument: a chunked reader needs at least two buffers");
+
+#ifdef PTRTOOLS_HAS_MMAP
+         struct stat info;
+
+         if (fstat(this->_fd, &info) != 0)
+            throw std::runtime_error("I/O error: could not query the file size");
+
+         this->_file_size = static_cast<std::uint64_t>(info.st_size);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+         posix_fadvise(this->_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+         this->_slots.resize(buffers);
+
+         for (auto &target : this->_slots)
+            target.buffer = array_ptr<std::uint8_t>(this->_carry_capacity + this->_chunk_size, allocation_mode::uninitialized);
+
+         this->_thread = std::thread(&chunked_reader::produce, this);
+#else
+         throw std::runtime_error("unsupported platform: chunked reads require pread");
+#endif
+      }
+
+   public:
+      chunked_reader(const std::string &path, std::size_t chunk_size=default_chunk_size, std::size_t buffers=2, std::size_t carry_capacity=default_carry_capacity)
+         : _chunk_size(chunk_size), _carry_capacity(carry_capacity)
+      {
+#ifdef PTRTOOLS_HAS_MMAP
+         this->_fd = ::open(path.c_str(), O_RDONLY);
+
+         if (this->_fd < 0)
+            throw std::runtime_error("I/O error: could not open the file");
+
+         try
+         {
+            this->start(buffers);
+         }
+         catch (...)
+         {
+            ::close(this->_fd);
+            throw;
+         }
+
+         this->_owns_fd = true;
+#else
+         (void)path;
+         (void)buffers;
+         throw std::runtime_error("unsupported platform: chunked reads require pread");
+#endif
+      }
+      // Reads from a descriptor the caller keeps open until the reader is destroyed.
+      chunked_reader(int fd, std::size_t chunk_size=default_chunk_size, std::size_t buffers=2, std::size_t carry_capacity=default_carry_capacity)
+         : _fd(fd), _chunk_size(chunk_size), _carry_capacity(carry_capacity)
+      {
+         this->start(buffers);
+      }
+      chunked_reader(const chunked_reader &other) = delete;
+      ~chunked_reader() {
+         {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_stopping = true;
+         }
+
+         this->_freed.notify_all();
+
+         if (this->_thread.joinable())
+            this->_thread.join();
+
+#ifdef PTRTOOLS_HAS_MMAP
+         if (this->_owns_fd)
+            ::close(this->_fd);
+#endif
+      }
+
+      chunked_reader &operator=(const chunked_reader &other) = delete;
+
+      std::uint64_t file_size() const { return this->_file_size; }
+      std::size_t chunk_size() const { return this->_chunk_size; }
+      std::size_t carry_capacity() const { return this->_carry_capacity; }
+      std::size_t buffers() const { return this->_slots.size(); }
+      // Chunks read ahead and waiting for next(), not counting the one the caller holds.
+      std::size_t buffered() const {
+         std::lock_guard<std::mutex> lock(this->_mutex);
+         std::size_t count = 0;
+
+         for (auto &target : this->_slots)
+            count += target.ready ? 1 : 0;
+
+         return this->_holding && count > 0 ? count - 1 : count;
+      }
+
+      // Keeps the last size bytes of the current chunk in front of the next one. Nothing follows
+      // the last chunk, so carrying bytes from it throws rather than dropping them.
+      void carry(std::size_t size) {
+         if (size > this->_current_size || size > this->_carry_capacity)
+            throw std::runtime_error("invalid argument: the carried bytes exceed the current chunk or the carry capacity");
+
+         if (size > 0 && this->_finished)
+            throw std::runtime_error("invalid argument: the last chunk has no next chunk to carry bytes into");
+
+         this->_carry = size;
+      }
+
+      // Waits for the next chunk and hands back the buffer of the current one for reading. At the
+      // end of the file it returns an empty chunk.
+      chunk next() {
+         if (this->_finished)
+         {
+            this->_current_size = 0;
+            return chunk();
+         }
+
+         auto &target = this->_slots[this->_consumed % this->_slots.size()];
+
+         {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_filled.wait(lock, [&]() { return target.ready; });
+
+            // chunks queued before a failed read are still handed out first
+            if (target.error != nullptr)
+            {
+               this->_finished = true;
+               this->_current_size = 0;
+               std::rethrow_exception(target.error);
+            }
+         }
+
+         std::size_t carried = 0;
+
+         if (this->_holding)
+         {
+            auto &previous = this->_slots[(this->_consumed - 1) % this->_slots.size()];
+
+            carried = this->_carry;
+
+            if (carried > 0)
+               std::memcpy(this->chunk_start(target) - carried, this->chunk_start(previous) + previous.size - carried, carried);
+
+            {
+               std::lock_guard<std::mutex> lock(this->_mutex);
+               previous.ready = false;
+            }
+
+            this->_freed.notify_one();
+         }
+
+         ++this->_consumed;
+         this->_holding = true;
+         this->_carry = 0;
+         this->_current_size = carried + target.size;
+         this->_finished = target.last;
+
+         return chunk(view_type(this->chunk_start(target) - carried, this->_current_size), target.offset - carried, carried, target.last);
+      }
+   };
+}
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef __PTRTOOLS_CURSOR_HPP
+#define __PTRTOOLS_CURSOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <ptrtools/policy.hpp>
+#include <ptrtools/view.hpp>
+
+namespace ptrtools
+{
+   // Sequential reader and writer over a byte buffer. Values are copied in and out with memcpy, so
+   // fields need not be aligned, and the position moves past each one. Every operation checks
+   // its own bounds through CheckPolicy. reserve() checks a fixed-size group of fields once and
+   // hands back a cursor over just those bytes whose checks are debug-only, so the group itself
+   // runs unchecked in release builds:
+   //
+   //    auto group = cursor.reserve(sizeof(std::uint32_t) * 2 + sizeof(std::uint16_t));
+   //    auto id = group.read<std::uint32_t>(), length = group.read<std::uint32_t>();
+   //    auto flags = group.read<be<std::uint16_t>>();
+   //
+   // The constness of the bytes is part of Byte: const_byte_cursor only reads.
+   template <typename Byte, typename CheckPolicy=default_policy>
+   class basic_byte_cursor
+   {
+      static_assert(std::is_same<typename std::remove_const<Byte>::type, std::uint8_t>::value, "Byte must be std::uint8_t or const std::uint8_t");
+
+   public:
+      using value_type = Byte;
+      using pointer = Byte *;
+      using check_policy = CheckPolicy;
+      using bytes_view_type = basic_view<Byte,1,1,CheckPolicy>;
+      using reserved_cursor = basic_byte_cursor<Byte,debug_policy>;
+
+      // longest LEB128 encoding of a 64-bit value
+      const static std::size_t max_varint_size = 10;
+
+   private:
+      pointer _data = nullptr;
+      std::size_t _size = 0;
+      std::size_t _position = 0;
+
+      template <typename Buffer>
+      static pointer buffer_data(Buffer &buffer) {
+         // a read-only cursor must not take the mutable get(), which detaches shared buffers
+         if constexpr (std::is_const<Byte>::value)
+            return reinterpret_cast<pointer>(std::as_const(buffer).get());
+         else
+            return reinterpret_cast<pointer>(buffer.get());
+      }
+
+      pointer advance(std::size_t size) {
+         CheckPolicy::check(size <= this->_size - this->_position, "out of bounds: the cursor operation runs past the end of the buffer");
+
+         auto result = this->_data + this->_position;
+         this->_position += size;
+
+         return result;
+      }
+
+      template <typename Length>
+      static Length prefix_of(std::size_t size) {
+         Length result;
+
+         if constexpr (std::is_integral<Length>::value)
+            result = static_cast<Length>(size);
+         else
+            result = Length(static_cast<typename Length::value_type>(size));
+
+         if (static_cast<std::size_t>(result) != size)
+            throw std::runtime_error("invalid argument: the buffer is too long for its length prefix");
+
+         return result;
+      }
+
+   public:
+      basic_byte_cursor() = default;
+      basic_byte_cursor(pointer data, std::size_t size) : _data(data), _size(size) {
+         CheckPolicy::check(data != nullptr || size == 0, "null pointer: attempting to create a cursor over a null pointer");
+      }
+      // Works over any byte pointer or view, such as a basic_ptr<std::uint8_t> or the pointer
+      // returned by mapped_file::ptr(). The buffer has to outlive the cursor and must not be
+      // reallocated while it is in use.
+      template <typename Buffer, typename = typename std::enable_if<sizeof(typename Buffer::value_type) == 1>::type>
+      basic_byte_cursor(Buffer &buffer) : basic_byte_cursor(buffer_data(buffer), buffer.size()) {}
+
+      pointer data() const { return this->_data; }
+      pointer current() const { return this->_data + this->_position; }
+      std::size_t size() const { return this->_size; }
+      std::size_t position() const { return this->_position; }
+      std::size_t remaining() const { return this->_size - this->_position; }
+      bool at_end() const { return this->_position == this->_size; }
+
+      void seek(std::size_t position) {
+         CheckPolicy::check(position <= this->_size, "out of bounds: the cursor position goes out of bounds of the buffer");
+
+         this->_position = position;
+      }
+      void skip(std::size_t size) { this->advance(size); }
+
+      // Checks that size bytes remain, moves past them and returns a cursor over them whose own
+      // bounds checks only run in debug builds.
+      reserved_cursor reserve(std::size_t size) {
+         return reserved_cursor(this->advance(size), size);
+      }
+
+      template <typename T>
+      T peek() const {
+         static_assert(std::is_trivially_copyable<T>::value, "Cursor values must be trivially copyable");
+
+         CheckPolicy::check(sizeof(T) <= this->remaining(), "out of bounds: the cursor operation runs past the end of the buffer");
+
+         T result;
+         std::memcpy(&result, this->current(), sizeof(T));
+
+         return result;
+      }
+      template <typename T>
+      T read() {
+         static_assert(std::is_trivially_copyable<T>::value, "Cursor values must be trivially copyable");
+
+         T result;
+         std::memcpy(&result, this->advance(sizeof(T)), sizeof(T));
+
+         return result;
+      }
+      void read(void *buffer, std::size_t size) {
+         std::memcpy(buffer, this->advance(size), size);
+      }
+      // Returns the next size bytes in place and moves past them.
+      bytes_view_type read_bytes(std::size_t size) {
+         return bytes_view_type(this->advance(size), size);
+      }
+
+      // Unsigned LEB128. Encodings that do not fit in T always throw, whatever the check policy,
+      // because they come from outside the program.
+      template <typename T=std::uint64_t>
+      T read_varint() {
+         static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value, "read_varint requires an unsigned integer type");
+
+         const unsigned bits = std::numeric_limits<T>::digits;
+         T result = 0;
+
+         for (unsigned shift=0;; shift+=7)
+         {
+            auto byte = *this->advance(1);
+            auto payload = static_cast<T>(byte & 0x7F);
+
+            if (shift >= bits || (bits - shift < 7 && (byte & 0x7F) >> (bits - shift) != 0))
+               throw std::runtime_error("invalid varint: the encoded value does not fit in the requested type");
+
+            result |= static_cast<T>(payload << shift);
+
+            if ((byte & 0x80) == 0)
+               return result;
+         }
+      }
+      // Signed LEB128. Encodings that do not fit in T always throw, like read_varint.
+      template <typename T=std::int64_t>
+      T read_signed_varint() {
+         static_assert(std::is_integral<T>::value && std::is_signed<T>::value, "read_signed_varint requires a signed integer type");
+
+         using unsigned_type = typename std::make_unsigned<T>::type;
+         // shifts in at least unsigned int width, since narrower types promote to signed int
+         using wide_type = typename std::common_type<unsigned_type,unsigned>::type;
+
+         const unsigned bits = std::numeric_limits<unsigned_type>::digits;
+         unsigned_type result = 0;
+         unsigned shift = 0;
+         std::uint8_t byte;
+
+         do
+         {
+            byte = *this->advance(1);
+
+            if (shift >= bits)
+               throw std::runtime_error("invalid varint: the encoded value does not fit in the requested type");
+
+            // on the last byte that fits, the payload bits from the sign bit up must all match it
+            if (bits - shift < 7)
+            {
+               auto high = (byte & 0x7F) >> (bits - shift - 1);
+
+               if (high != 0 && high != (0x7F >> (bits - shift - 1)))
+                  throw std::runtime_error("invalid varint: the encoded value does not fit in the requested type");
+            }
+
+            result |= static_cast<unsigned_type>(static_cast<wide_type>(byte & 0x7F) << shift);
+            shift += 7;
+         } while (byte & 0x80);
+
+         if (shift < bits && (byte & 0x40) != 0)
+            result |= static_cast<unsigned_type>(~wide_type(0) << shift);
+
+         return static_cast<T>(result);
+      }
+
+      // Length-prefixed bytes, returned in place. Length is an integer or endian value type. A
+      // prefix longer than the rest of the buffer always throws.
+      template <typename Length=std::uint32_t>
+      bytes_view_type read_prefixed() {
+         auto length = static_cast<std::size_t>(this->template read<Length>());
+
+         if (length > this->remaining())
+            throw std::runtime_error("out of bounds: the length prefix runs past the end of the buffer");
+
+         return this->read_bytes(length);
+      }
+      bytes_view_type read_varint_prefixed() {
+         auto length = this->template read_varint<std::uint64_t>();
+
+         if (length > this->remaining())
+            throw std::runtime_error("out of bounds: the length prefix runs past the end of the buffer");
+
+         return this->read_bytes(static_cast<std::size_t>(length));
+      }
+
+      template <typename T, typename U=Byte, typename = typename std::enable_if<!std::is_const<U>::value>::type>
+      void write(const T &value) {
+         static_assert(std::is_trivially_copyable<T>::value, "Cursor values must be trivially copyable");
+
+         std::memcpy(this->advance(sizeof(T)), &value, sizeof(T));
+      }
+      template <typename U=Byte, typename = typename std::enable_if<!std::is_const<U>::value>::type>
+      void write(const void *buffer, std::size_t size) {
+         std::memcpy(this->advance(size), buffer, size);
+      }
+
+      template <typename T, typename U=Byte, typename = typename std::enable_if<!std::is_const<U>::value>::type>
+      void write_varint(T value) {
+         static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value, "write_varint requires an unsigned integer type");
+
+         // encoded locally so the whole value is bounds checked once
+         std::uint8_t encoded[max_varint_size];
+         std::size_t size = 0;
+
+         do
+         {
+            auto byte = static_cast<std::uint8_t>(value & 0x7F);
+            value = static_cast<T>(value >> 7);
+            encoded[size++] = static_cast<std::uint8_t>(value != 0 ? byte | 0x80 : byte);
+         } while (value != 0);
+
+         std::memcpy(this->advance(size), encoded, size);
+      }
+      template <typename T, typename U=Byte, typename = typename std::enable_if<!std::is_const<U>::value>::type>
+      void write_signed_varint(T value) {
+         static_assert(std::is_integral<T>::value && std::is_signed<T>::value, "write_signed_varint requires a signed integer type");
+
+         std::uint8_t encoded[max_varint_size];
+         std::size_t size = 0;
+         bool more = true;
+
+         while (more)
+         {
+            auto byte = static_cast<std::uint8_t>(value & 0x7F);
+            value = static_cast<T>(value >> 7);
+            more = !((value == 0 && (byte & 0x40) == 0) || (value == -1 && (byte & 0x40) != 0));
+            encoded[size++] = static_cast<std::uint8_t>(more ? byte | 0x80 : byte);
+         }
+
+         std::memcpy(this->advance(size), encoded, size);
+      }
+
+      template <typename Length=std::uint32_t, typename U=Byte, typename = typename std::enable_if<!std::is_const<U>::value>::type>
+      void write_prefixed(const void *buffer, std::size_t size) {
+         auto prefix = prefix_of<Length>(size);
+
+         CheckPolicy::check(sizeof(Length) + size <= this->remaining(), "out of bounds: the cursor operation runs past the end of the buffer");
+
+         this->write(prefix);
+         this->write(buffer, size);
+      }
+      template <typename U=Byte, typename = typename std::enable_if<!std::is_const<U>::value>::type>
+      void write_varint_prefixed(const void *buffer, std::size_t size) {
+         this->write_varint(static_cast<std::uint64_t>(size));
+         this->write(buffer, size);
+      }
+   };
+
+   using byte_cursor = basic_byte_cursor<std::uint8_t>;
+   using const_byte_cursor = basic_byte_cursor<const std::uint8_t>;
+}
+
+#endif
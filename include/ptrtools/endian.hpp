@@ -0,0 +1,239 @@
+#ifndef __PTRTOOLS_ENDIAN_HPP
+#define __PTRTOOLS_ENDIAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <ptrtools/simd.hpp>
+
+namespace ptrtools
+{
+   enum class byte_order
+   {
+      little,
+      big,
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      native = big
+#else
+      native = little
+#endif
+   };
+
+   inline std::uint8_t byteswap_bits(std::uint8_t value) { return value; }
+   inline std::uint16_t byteswap_bits(std::uint16_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return __builtin_bswap16(value);
+#else
+      return static_cast<std::uint16_t>((value << 8) | (value >> 8));
+#endif
+   }
+   inline std::uint32_t byteswap_bits(std::uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return __builtin_bswap32(value);
+#else
+      return (value << 24) | ((value & 0xFF00) << 8) | ((value >> 8) & 0xFF00) | (value >> 24);
+#endif
+   }
+   inline std::uint64_t byteswap_bits(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return __builtin_bswap64(value);
+#else
+      return (static_cast<std::uint64_t>(byteswap_bits(static_cast<std::uint32_t>(value))) << 32) | byteswap_bits(static_cast<std::uint32_t>(value >> 32));
+#endif
+   }
+
+   template <typename T>
+   T byteswap(const T &value) {
+      static_assert(std::is_trivially_copyable<T>::value && simd::has_lane_width<T>::value, "byteswap requires a trivially copyable type of 1, 2, 4 or 8 bytes");
+
+      auto bits = byteswap_bits(simd::bits_of(value));
+      T result;
+
+      std::memcpy(&result, &bits, sizeof(T));
+
+      return result;
+   }
+
+   // Storage for a T kept in the given byte order, converted on every read and write. It has the
+   // size and alignment of T, so it can stand in for a field of a struct overlaid with struct_ptr
+   // or flexible_ptr. The raw bits are held as an unsigned integer so that swapped floating point
+   // values are never loaded as floats.
+   template <typename T, byte_order Order>
+   class endian_value
+   {
+      static_assert(std::is_trivially_copyable<T>::value && simd::has_lane_width<T>::value, "Endian values must be trivially copyable types of 1, 2, 4 or 8 bytes");
+
+   public:
+      using value_type = T;
+      using bits_type = typename simd::unsigned_of<sizeof(T)>::type;
+
+      const static byte_order order = Order;
+
+   private:
+      alignas(T) bits_type _bits;
+
+      static bits_type convert(bits_type bits) { return Order == byte_order::native ? bits : byteswap_bits(bits); }
+
+   public:
+      endian_value() = default;
+      endian_value(const T &value) { this->set(value); }
+
+      endian_value &operator=(const T &value) { this->set(value); return *this; }
+      operator T() const { return this->get(); }
+
+      T get() const {
+         auto bits = convert(this->_bits);
+         T result;
+
+         std::memcpy(&result, &bits, sizeof(T));
+
+         return result;
+      }
+      void set(const T &value) { this->_bits = convert(simd::bits_of(value)); }
+      bits_type raw() const { return this->_bits; }
+   };
+
+   template <typename T>
+   using be = endian_value<T,byte_order::big>;
+
+   template <typename T>
+   using le = endian_value<T,byte_order::little>;
+
+namespace simd
+{
+   // Byte position of every lane after swapping, repeated per 16-byte block as pshufb expects.
+   template <std::size_t Width>
+   struct byteswap_indexes
+   {
+      alignas(64) std::uint8_t bytes[64];
+
+      byteswap_indexes() {
+         for (std::size_t i=0; i<64; ++i)
+            this->bytes[i] = static_cast<std::uint8_t>((i % 16) / Width * Width + Width - 1 - i % Width);
+      }
+   };
+
+   struct scalar_byteswap
+   {
+      template <typename U>
+      static void byteswap(U *data, std::size_t n) {
+         for (std::size_t i=0; i<n; ++i)
+            data[i] = byteswap_bits(data[i]);
+      }
+   };
+
+#ifdef PTRTOOLS_SIMD_X86
+   // SSE2 has no byte shuffle: swap the 16-bit halves with word shuffles, then the bytes within
+   // each 16-bit word with shifts.
+   struct sse2_byteswap
+   {
+      template <typename U>
+      PTRTOOLS_TARGET_SSE2 static __m128i swap_block(__m128i block) {
+         if constexpr (sizeof(U) == 4)
+            block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+         else if constexpr (sizeof(U) == 8)
+            block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, _MM_SHUFFLE(0,1,2,3)), _MM_SHUFFLE(0,1,2,3));
+
+         return _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_SSE2 static void byteswap(U *data, std::size_t n) {
+         const std::size_t lanes = 16 / sizeof(U);
+         std::size_t i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+         {
+            auto address = reinterpret_cast<__m128i *>(data + i);
+            _mm_storeu_si128(address, swap_block<U>(_mm_loadu_si128(address)));
+         }
+
+         scalar_byteswap::byteswap(data + i, n - i);
+      }
+   };
+
+   struct avx2_byteswap
+   {
+      template <typename U>
+      PTRTOOLS_TARGET_AVX2 static void byteswap(U *data, std::size_t n) {
+         static const byteswap_indexes<sizeof(U)> indexes;
+         const std::size_t lanes = 32 / sizeof(U);
+         auto shuffle = _mm256_load_si256(reinterpret_cast<const __m256i *>(indexes.bytes));
+         std::size_t i = 0;
+
+         for (; i + lanes * 2 <= n; i += lanes * 2)
+         {
+            auto first = reinterpret_cast<__m256i *>(data + i);
+            auto second = reinterpret_cast<__m256i *>(data + i + lanes);
+            auto first_block = _mm256_shuffle_epi8(_mm256_loadu_si256(first), shuffle);
+            auto second_block = _mm256_shuffle_epi8(_mm256_loadu_si256(second), shuffle);
+
+            _mm256_storeu_si256(first, first_block);
+            _mm256_storeu_si256(second, second_block);
+         }
+
+         for (; i + lanes <= n; i += lanes)
+         {
+            auto address = reinterpret_cast<__m256i *>(data + i);
+            _mm256_storeu_si256(address, _mm256_shuffle_epi8(_mm256_loadu_si256(address), shuffle));
+         }
+
+         scalar_byteswap::byteswap(data + i, n - i);
+      }
+   };
+
+   struct avx512_byteswap
+   {
+      template <typename U>
+      PTRTOOLS_TARGET_AVX512 static void byteswap(U *data, std::size_t n) {
+         static const byteswap_indexes<sizeof(U)> indexes;
+         const std::size_t lanes = 64 / sizeof(U);
+         auto shuffle = _mm512_load_si512(indexes.bytes);
+         std::size_t i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+            _mm512_storeu_si512(data + i, _mm512_shuffle_epi8(_mm512_loadu_si512(data + i), shuffle));
+
+         if (i < n)
+         {
+            // finish with one masked block instead of a scalar tail
+            auto mask = _cvtu64_mask64((1ull << ((n - i) * sizeof(U))) - 1);
+            auto block = _mm512_maskz_loadu_epi8(mask, data + i);
+
+            _mm512_mask_storeu_epi8(data + i, mask, _mm512_shuffle_epi8(block, shuffle));
+         }
+      }
+   };
+#endif
+
+   // Reverses the bytes of every element in place.
+   template <typename T>
+   void byteswap(T *data, std::size_t n) {
+      static_assert(std::is_trivially_copyable<T>::value && has_lane_width<T>::value, "byteswap requires a trivially copyable type of 1, 2, 4 or 8 bytes");
+
+      if constexpr (sizeof(T) > 1)
+      {
+         using bits = typename unsigned_of<sizeof(T)>::type;
+         auto words = reinterpret_cast<bits *>(data);
+
+         switch (active_level())
+         {
+#ifdef PTRTOOLS_SIMD_X86
+         case level::avx512: avx512_byteswap::byteswap(words, n); break;
+         case level::avx2: avx2_byteswap::byteswap(words, n); break;
+         case level::sse2: sse2_byteswap::byteswap(words, n); break;
+#endif
+         default: scalar_byteswap::byteswap(words, n); break;
+         }
+      }
+      else
+      {
+         (void)data;
+         (void)n;
+      }
+   }
+}
+}
+
+#endif
@@ -10,24 +10,37 @@ namespace ptrtools
       typename T,
       typename FlexibleType,
       std::size_t StructElements=1,
-      typename Allocator=std::allocator<std::uint8_t>>
-   class flexible_ptr : public struct_ptr<T,Allocator>
+      typename Allocator=std::allocator<std::uint8_t>,
+      typename CheckPolicy=default_policy>
+   class flexible_ptr : public struct_ptr<T,Allocator,CheckPolicy>
    {
    public:
-      using struct_ptr_decl = struct_ptr<T,Allocator>;
+      using struct_ptr_decl = struct_ptr<T,Allocator,CheckPolicy>;
       using value_type = typename struct_ptr_decl::value_type;
       using pointer = typename struct_ptr_decl::pointer;
       using const_pointer = typename struct_ptr_decl::const_pointer;
       using reference = typename struct_ptr_decl::reference;
       using const_reference = typename struct_ptr_decl::const_reference;
       using allocator = Allocator;
+      using check_policy = CheckPolicy;
       using flexible_type = FlexibleType;
+      using flexible_view_type = array_view<FlexibleType,CheckPolicy>;
+      using const_flexible_view_type = array_view<const FlexibleType,CheckPolicy>;
+      using iterator = basic_iterator<FlexibleType,sizeof(FlexibleType),CheckPolicy,false>;
+      using const_iterator = basic_iterator<const FlexibleType,sizeof(FlexibleType),CheckPolicy,false>;
+      using reverse_iterator = basic_iterator<FlexibleType,sizeof(FlexibleType),CheckPolicy,true>;
+      using const_reverse_iterator = basic_iterator<const FlexibleType,sizeof(FlexibleType),CheckPolicy,true>;
 
       const static std::size_t struct_elements = StructElements;
+      const static std::size_t flexible_offset = sizeof(T) - sizeof(FlexibleType) * StructElements;
 
       flexible_ptr() : struct_ptr_decl(false) {}
-      flexible_ptr(std::size_t elements) {
-         this->allocate(elements);
+      flexible_ptr(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
+         this->allocate(elements, mode);
+      }
+      flexible_ptr(const Allocator &allocator) : struct_ptr_decl(allocator) {}
+      flexible_ptr(std::size_t elements, const Allocator &allocator, allocation_mode mode=allocation_mode::zeroed) : struct_ptr_decl(allocator) {
+         this->allocate(elements, mode);
       }
       flexible_ptr(pointer ptr, std::size_t elements, bool clone=false) {
          if (clone)
@@ -45,22 +58,22 @@ namespace ptrtools
       flexible_ptr(const typename struct_ptr_decl::basic_ptr_decl &ptr) : struct_ptr_decl(ptr) {}
       flexible_ptr(struct_ptr_decl &ptr) : struct_ptr_decl(ptr) {}
       flexible_ptr(const struct_ptr_decl &ptr) : struct_ptr_decl(ptr) {}
-      flexible_ptr(flexible_ptr<T,FlexibleType,StructElements,Allocator> &other) : struct_ptr_decl(static_cast<struct_ptr_decl &>(other)) {}
-      flexible_ptr(const flexible_ptr<T,FlexibleType,StructElements,Allocator> &other) : struct_ptr_decl(static_cast<const struct_ptr_decl &>(other)) {}
-      flexible_ptr(flexible_ptr<T,FlexibleType,StructElements,Allocator> &&other) : struct_ptr_decl(static_cast<struct_ptr_decl &&>(other)) {}
+      flexible_ptr(flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &other) : struct_ptr_decl(static_cast<struct_ptr_decl &>(other)) {}
+      flexible_ptr(const flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &other) : struct_ptr_decl(static_cast<const struct_ptr_decl &>(other)) {}
+      flexible_ptr(flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &&other) : struct_ptr_decl(static_cast<struct_ptr_decl &&>(other)) {}
       ~flexible_ptr() {}
 
-      flexible_ptr<T,FlexibleType,StructElements,Allocator> &operator=(flexible_ptr<T,FlexibleType,StructElements,Allocator> &other) {
+      flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &operator=(flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &other) {
          struct_ptr_decl::operator=(static_cast<struct_ptr_decl &>(other));
 
          return *this;
       }
-      flexible_ptr<T,FlexibleType,StructElements,Allocator> &operator=(const flexible_ptr<T,FlexibleType,StructElements,Allocator> &other) {
+      flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &operator=(const flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &other) {
          struct_ptr_decl::operator=(static_cast<const struct_ptr_decl &>(other));
 
          return *this;
       }
-      flexible_ptr<T,FlexibleType,StructElements,Allocator> &operator=(flexible_ptr<T,FlexibleType,StructElements,Allocator> &&other) {
+      flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &operator=(flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &&other) {
          struct_ptr_decl::operator=(static_cast<struct_ptr_decl &&>(other));
 
          return *this;
@@ -69,28 +82,123 @@ namespace ptrtools
    private:
       using struct_ptr_decl::allocate;
       using struct_ptr_decl::reallocate;
+      using struct_ptr_decl::reserve;
+      using struct_ptr_decl::capacity;
       using struct_ptr_decl::resize;
       using struct_ptr_decl::set;
       using struct_ptr_decl::clone;
 
+      // The trailing array always starts flexible_offset bytes into the struct, so its base is
+      // computed from the struct pointer instead of going through ptr_at.
+      template <typename Pointer>
+      static Pointer flexible_at(Pointer base, std::size_t index) {
+         if (base == nullptr)
+            return nullptr;
+
+         return reinterpret_cast<Pointer>(reinterpret_cast<std::uintptr_t>(base) + flexible_offset + index * sizeof(FlexibleType));
+      }
+      template <typename Pointer>
+      static Pointer advance(Pointer data, std::ptrdiff_t count) {
+         if (data == nullptr)
+            return nullptr;
+
+         return reinterpret_cast<Pointer>(reinterpret_cast<std::uintptr_t>(data) + count * static_cast<std::ptrdiff_t>(sizeof(FlexibleType)));
+      }
+      void check_header() const {
+         if (this->is_null())
+            throw std::runtime_error("null pointer: the flexible array has no header to grow from");
+      }
+      std::size_t checked_index(const_pointer base, std::size_t index) const {
+         CheckPolicy::check(base != nullptr, "null pointer: attempting to access a null pointer");
+         CheckPolicy::check(index < this->elements(), "out of bounds: the given index goes out of bounds of the flexible array");
+
+         return index;
+      }
+
    public:
-      FlexibleType &operator[](std::size_t index) { return this->flexible_array()[index]; }
-      const FlexibleType &operator[](std::size_t index) const { return this->flexible_array()[index]; }
+      FlexibleType &operator[](std::size_t index) {
+         auto base = this->get();
+
+         return *flexible_at(reinterpret_cast<FlexibleType *>(base), this->checked_index(base, index));
+      }
+      const FlexibleType &operator[](std::size_t index) const {
+         auto base = this->get();
+
+         return *flexible_at(reinterpret_cast<const FlexibleType *>(base), this->checked_index(base, index));
+      }
       
-      std::size_t adjusted_type_size() const { return this->type_size - (sizeof(FlexibleType) * this->struct_elements); }
-      std::size_t elements() const { return (this->size() - this->adjusted_type_size()) / sizeof(FlexibleType); }
+      std::size_t adjusted_type_size() const { return flexible_offset; }
+      std::size_t elements() const { return this->size() > flexible_offset ? (this->size() - flexible_offset) / sizeof(FlexibleType) : 0; }
+
+      FlexibleType *flexible_data() { return flexible_at(reinterpret_cast<FlexibleType *>(this->get()), 0); }
+      const FlexibleType *flexible_data() const { return flexible_at(reinterpret_cast<const FlexibleType *>(this->get()), 0); }
+
+      iterator begin() { return iterator(this->flexible_data()); }
+      const_iterator begin() const { return this->cbegin(); }
+      const_iterator cbegin() const { return const_iterator(this->flexible_data()); }
+      reverse_iterator rbegin() { return reverse_iterator(advance(this->flexible_data(), static_cast<std::ptrdiff_t>(this->elements()) - 1)); }
+      const_reverse_iterator rbegin() const { return this->crbegin(); }
+      const_reverse_iterator crbegin() const { return const_reverse_iterator(advance(this->flexible_data(), static_cast<std::ptrdiff_t>(this->elements()) - 1)); }
+      iterator end() { return iterator(advance(this->flexible_data(), static_cast<std::ptrdiff_t>(this->elements()))); }
+      const_iterator end() const { return this->cend(); }
+      const_iterator cend() const { return const_iterator(advance(this->flexible_data(), static_cast<std::ptrdiff_t>(this->elements()))); }
+      reverse_iterator rend() { return reverse_iterator(advance(this->flexible_data(), -1)); }
+      const_reverse_iterator rend() const { return this->crend(); }
+      const_reverse_iterator crend() const { return const_reverse_iterator(advance(this->flexible_data(), -1)); }
             
-      void allocate(std::size_t elements) {
+      void allocate(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
          if (elements < this->struct_elements)
             throw std::runtime_error("insufficient size: not enough elements given to allocate flexible array structure");
          
-         struct_ptr_decl::allocate(this->adjusted_type_size() + elements * sizeof(FlexibleType));
+         struct_ptr_decl::allocate(this->adjusted_type_size() + elements * sizeof(FlexibleType), mode);
       }
-      void reallocate(std::size_t elements) {
+      void allocate(std::size_t elements, const Allocator &allocator, allocation_mode mode=allocation_mode::zeroed) {
          if (elements < this->struct_elements)
             throw std::runtime_error("insufficient size: not enough elements given to allocate flexible array structure");
          
-         struct_ptr_decl::reallocate(this->adjusted_type_size() + elements * sizeof(FlexibleType));
+         struct_ptr_decl::allocate(this->adjusted_type_size() + elements * sizeof(FlexibleType), allocator, mode);
+      }
+      void reallocate(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
+         if (elements < this->struct_elements)
+            throw std::runtime_error("insufficient size: not enough elements given to allocate flexible array structure");
+
+         auto size = this->adjusted_type_size() + elements * sizeof(FlexibleType);
+
+         // grow geometrically so that adding entries one at a time stays amortized O(1)
+         this->reallocate_to(size, this->grow_capacity(size), mode);
+      }
+      void reserve(std::size_t elements) {
+         this->check_header();
+
+         struct_ptr_decl::reserve(this->adjusted_type_size() + elements * sizeof(FlexibleType));
+      }
+      // Flexible elements that fit without reallocating. size() always stays the exact size of
+      // the header plus elements(), so the spare capacity never shows up in the wire size.
+      std::size_t capacity() const {
+         auto bytes = struct_ptr_decl::capacity();
+
+         return bytes > this->adjusted_type_size() ? (bytes - this->adjusted_type_size()) / sizeof(FlexibleType) : 0;
+      }
+      void push_back(const FlexibleType &value) {
+         this->emplace_back(value);
+      }
+      template <typename... Args>
+      FlexibleType &emplace_back(Args&&... args) {
+         this->check_header();
+
+         return *this->template emplace_tail<FlexibleType>(sizeof(FlexibleType), std::forward<Args>(args)...);
+      }
+      void append(const FlexibleType *ptr, std::size_t elements) {
+         if (elements == 0)
+            return;
+
+         this->check_header();
+         this->append_tail(ptr, elements * sizeof(FlexibleType));
+      }
+      // Appends every element of a contiguous range such as an array_ptr or array_view.
+      template <typename Range>
+      void append(const Range &range) {
+         this->append(range.get(), range.elements());
       }
       void resize(std::size_t elements) {
          if (elements < this->struct_elements)
@@ -118,8 +226,8 @@ namespace ptrtools
 
          struct_ptr_decl::clone(ptr, this->adjusted_type_size() + elements * sizeof(FlexibleType));
       }
-      void clone(const flexible_ptr<T,FlexibleType,StructElements,Allocator> &other) {
-         flexible_ptr<T,FlexibleType,StructElements,Allocator>::clone(other.get(), other.elements());
+      void clone(const flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &other) {
+         flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy>::clone(other.get(), other.elements());
       }
       void copy(const_pointer ptr, std::size_t elements) {
          if (elements < this->struct_elements)
@@ -127,25 +235,14 @@ namespace ptrtools
 
          struct_ptr_decl::copy(ptr, this->adjusted_type_size() + elements * sizeof(FlexibleType));
       }
-      void copy(const flexible_ptr<T,FlexibleType,StructElements,Allocator> &other) {
-         flexible_ptr<T,FlexibleType,StructElements,Allocator>::copy(other.get(), other.elements());
+      void copy(const flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy> &other) {
+         flexible_ptr<T,FlexibleType,StructElements,Allocator,CheckPolicy>::copy(other.get(), other.elements());
       }
 
-      array_ptr<FlexibleType,Allocator> flexible_array() {
-         // keep the ptr object on the stack so it doesn't get passed as const to the constructor
-         auto ptr = this->template ptr_at<FlexibleType,sizeof(FlexibleType),alignof(FlexibleType)>(this->adjusted_type_size(), false);
-         auto result = array_ptr<FlexibleType,Allocator>(ptr);
-         result.resize(this->elements());
-
-         return result;
-      }
-      const array_ptr<FlexibleType,Allocator> flexible_array() const {
-         auto ptr = this->template ptr_at<FlexibleType,sizeof(FlexibleType),alignof(FlexibleType)>(this->adjusted_type_size(), false);
-         auto result = array_ptr<FlexibleType,Allocator>(ptr);
-         result.resize(this->elements());
-
-         return result;
-      }
+      flexible_view_type flexible_view() { return flexible_view_type(this->flexible_data(), this->elements()); }
+      const_flexible_view_type flexible_view() const { return const_flexible_view_type(this->flexible_data(), this->elements()); }
+      flexible_view_type flexible_array() { return this->flexible_view(); }
+      const_flexible_view_type flexible_array() const { return this->flexible_view(); }
    };
 }
 
@@ -0,0 +1,46 @@
+#ifndef __PTRTOOLS_HANDLE_HPP
+#define __PTRTOOLS_HANDLE_HPP
+
+#include <type_traits>
+
+#include <ptrtools/policy.hpp>
+
+namespace ptrtools
+{
+   // A single-word, trivially-copyable reference to one element inside a basic_ptr. Unlike the
+   // basic_ptr returned by ptr_at, a handle carries no size, allocator or vtable, so it is free to
+   // create and discard inside a loop.
+   template <typename T, typename CheckPolicy=default_policy>
+   class element_handle
+   {
+   public:
+      using value_type = T;
+      using pointer = value_type *;
+      using reference = value_type &;
+      using check_policy = CheckPolicy;
+
+   private:
+      pointer _ptr = nullptr;
+
+   public:
+      element_handle() = default;
+      element_handle(pointer ptr) : _ptr(ptr) {}
+
+      template <typename U=T, typename = typename std::enable_if<!std::is_const<U>::value>::type>
+      operator element_handle<const U, CheckPolicy>() const { return element_handle<const U, CheckPolicy>(this->_ptr); }
+
+      bool operator==(const element_handle<T,CheckPolicy> &other) const { return this->_ptr == other._ptr; }
+      bool operator!=(const element_handle<T,CheckPolicy> &other) const { return this->_ptr != other._ptr; }
+      reference operator*() const {
+         CheckPolicy::check(this->_ptr != nullptr, "null pointer: attempting to dereference a null handle");
+
+         return *this->_ptr;
+      }
+      pointer operator->() const { return &**this; }
+
+      bool is_null() const { return this->_ptr == nullptr; }
+      pointer get() const { return this->_ptr; }
+   };
+}
+
+#endif
@@ -0,0 +1,390 @@
+#ifndef __PTRTOOLS_INSTRUMENT_HPP
+#define __PTRTOOLS_INSTRUMENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef PTRTOOLS_INSTRUMENT
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <typeinfo>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#endif
+#endif
+
+namespace ptrtools
+{
+namespace instrument
+{
+   // Allocation and copy accounting for every basic_ptr and the pointers built on it, broken down
+   // by element type. It is compiled in only when PTRTOOLS_INSTRUMENT is defined; otherwise
+   // every hook is an empty inline function and snapshot() reports nothing.
+   //
+   // Counts and live bytes are kept per thread and only summed when a snapshot is taken, so the
+   // hooks never contend. Peaks need a running total across threads, which each thread only
+   // updates once its own live bytes have moved by peak_granularity.
+   enum class event
+   {
+      allocate,
+      deallocate,
+      reallocate,
+      clone,
+      copy,
+      consume
+   };
+
+   const std::size_t event_count = 6;
+
+   inline const char *event_name(event value) {
+      switch (value)
+      {
+      case event::allocate: return "allocate";
+      case event::deallocate: return "deallocate";
+      case event::reallocate: return "reallocate";
+      case event::clone: return "clone";
+      case event::copy: return "copy";
+      case event::consume: return "consume";
+      }
+
+      return "unknown";
+   }
+
+   struct counter
+   {
+      std::uint64_t calls = 0;
+      std::uint64_t bytes = 0;
+   };
+
+   struct type_report
+   {
+      std::string type;
+      counter events[event_count];
+      std::int64_t live_bytes = 0;
+      std::uint64_t peak_bytes = 0;
+
+      const counter &operator[](event value) const { return this->events[static_cast<std::size_t>(value)]; }
+   };
+
+   using sink = std::function<void(const std::vector<type_report> &)>;
+
+   // Live bytes are published to the shared peak in steps of this size per thread, so a peak may
+   // be reported up to this much low for every thread that allocates the type.
+   const std::int64_t peak_granularity = 64 * 1024;
+
+#ifdef PTRTOOLS_INSTRUMENT
+   const bool enabled = true;
+
+   // Types past the limit are all counted in the last slot.
+   const std::size_t max_types = 128;
+
+   struct thread_counters;
+
+   // Trivially destructible, so it can still be read after the thread's counters are gone, e.g.
+   // by a static basic_ptr released during exit.
+   struct thread_state
+   {
+      thread_counters *counters = nullptr;
+      bool finished = false;
+   };
+
+   inline thread_state &state() {
+      thread_local thread_state value;
+      return value;
+   }
+
+   inline std::string type_name(const char *name) {
+#if defined(__GNUC__) || defined(__clang__)
+      int status = 0;
+      char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+      if (status == 0 && demangled != nullptr)
+      {
+         std::string result(demangled);
+         std::free(demangled);
+
+         return result;
+      }
+#endif
+
+      return name;
+   }
+
+   struct registry
+   {
+      std::mutex mutex;
+      std::vector<thread_counters *> threads;
+      std::uint64_t retired[max_types][event_count][2] = {};
+      std::uint64_t baseline[max_types][event_count][2] = {};
+      std::int64_t retired_live[max_types] = {};
+      std::string names[max_types];
+      std::size_t types = 0;
+      std::atomic<std::int64_t> published[max_types] = {};
+      std::atomic<std::uint64_t> peak[max_types] = {};
+      instrument::sink sink;
+
+      std::size_t register_type(const char *name) {
+         std::lock_guard<std::mutex> lock(this->mutex);
+
+         if (this->types == max_types - 1)
+         {
+            this->names[max_types - 1] = "(other types)";
+            return max_types - 1;
+         }
+
+         this->names[this->types] = type_name(name);
+
+         return this->types++;
+      }
+      void raise_peak(std::size_t type, std::int64_t live) {
+         if (live <= 0)
+            return;
+
+         auto peak = this->peak[type].load(std::memory_order_relaxed);
+
+         while (static_cast<std::uint64_t>(live) > peak && !this->peak[type].compare_exchange_weak(peak, static_cast<std::uint64_t>(live), std::memory_order_relaxed));
+      }
+      void publish(std::size_t type, std::int64_t delta) {
+         this->raise_peak(type, this->published[type].fetch_add(delta, std::memory_order_relaxed) + delta);
+      }
+      // Exact live bytes; the caller holds the mutex.
+      std::int64_t live(std::size_t type) const;
+   };
+
+   inline registry &global() {
+      // never destroyed: threads that exit during static teardown still fold their counts into it
+      static registry *instance = new registry();
+      return *instance;
+   }
+
+   struct thread_counters
+   {
+      // only the owning thread writes, so plain loads and stores are enough; the atomics are
+      // there so that snapshots can read them from other threads
+      std::atomic<std::uint64_t> values[max_types][event_count][2];
+      std::atomic<std::int64_t> live[max_types];
+      std::int64_t unpublished[max_types] = {};
+
+      thread_counters() {
+         for (std::size_t type=0; type<max_types; ++type)
+         {
+            for (auto &slot : this->values[type])
+            {
+               slot[0].store(0, std::memory_order_relaxed);
+               slot[1].store(0, std::memory_order_relaxed);
+            }
+
+            this->live[type].store(0, std::memory_order_relaxed);
+         }
+
+         auto &instance = global();
+         std::lock_guard<std::mutex> lock(instance.mutex);
+         instance.threads.push_back(this);
+         state().counters = this;
+      }
+      ~thread_counters() {
+         state().counters = nullptr;
+         state().finished = true;
+
+         auto &instance = global();
+         std::lock_guard<std::mutex> lock(instance.mutex);
+
+         for (std::size_t type=0; type<max_types; ++type)
+         {
+            for (std::size_t index=0; index<event_count; ++index)
+            {
+               instance.retired[type][index][0] += this->values[type][index][0].load(std::memory_order_relaxed);
+               instance.retired[type][index][1] += this->values[type][index][1].load(std::memory_order_relaxed);
+            }
+
+            instance.retired_live[type] += this->live[type].load(std::memory_order_relaxed);
+
+            if (this->unpublished[type] != 0)
+               instance.publish(type, this->unpublished[type]);
+         }
+
+         for (auto iter=instance.threads.begin(); iter!=instance.threads.end(); ++iter)
+         {
+            if (*iter == this)
+            {
+               instance.threads.erase(iter);
+               break;
+            }
+         }
+      }
+   };
+
+   inline std::int64_t registry::live(std::size_t type) const {
+      auto result = this->retired_live[type];
+
+      for (auto thread : this->threads)
+         result += thread->live[type].load(std::memory_order_relaxed);
+
+      return result;
+   }
+
+   inline thread_counters *local() {
+      auto &current = state();
+
+      if (current.counters != nullptr || current.finished)
+         return current.counters;
+
+      thread_local thread_counters counters;
+      return &counters;
+   }
+
+   template <typename T>
+   std::size_t type_index() {
+      static const std::size_t index = global().register_type(typeid(T).name());
+      return index;
+   }
+
+   template <typename T>
+   inline void record(event value, std::size_t bytes) {
+      auto index = type_index<T>();
+      auto counters = local();
+
+      if (counters == nullptr)
+      {
+         // the thread is exiting and its counters are gone
+         auto &instance = global();
+         std::lock_guard<std::mutex> lock(instance.mutex);
+
+         instance.retired[index][static_cast<std::size_t>(value)][0] += 1;
+         instance.retired[index][static_cast<std::size_t>(value)][1] += bytes;
+         return;
+      }
+
+      auto &slot = counters->values[index][static_cast<std::size_t>(value)];
+
+      slot[0].store(slot[0].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      slot[1].store(slot[1].load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+   }
+   template <typename T>
+   inline void record_live(std::int64_t delta) {
+      auto index = type_index<T>();
+      auto counters = local();
+
+      if (counters == nullptr)
+      {
+         auto &instance = global();
+         std::lock_guard<std::mutex> lock(instance.mutex);
+
+         instance.retired_live[index] += delta;
+         instance.publish(index, delta);
+         return;
+      }
+
+      auto &live = counters->live[index];
+      auto &unpublished = counters->unpublished[index];
+
+      live.store(live.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+      unpublished += delta;
+
+      if (unpublished >= peak_granularity || unpublished <= -peak_granularity)
+      {
+         global().publish(index, unpublished);
+         unpublished = 0;
+      }
+   }
+
+   // Counts since the last reset(), one report per element type seen so far.
+   inline std::vector<type_report> snapshot() {
+      auto &instance = global();
+      std::lock_guard<std::mutex> lock(instance.mutex);
+      std::vector<type_report> result(instance.types + (instance.names[max_types - 1].empty() ? 0 : 1));
+
+      for (std::size_t index=0; index<result.size(); ++index)
+      {
+         auto type = index < instance.types ? index : max_types - 1;
+         auto &report = result[index];
+
+         report.type = instance.names[type];
+         report.live_bytes = instance.live(type);
+         instance.raise_peak(type, report.live_bytes);
+         report.peak_bytes = instance.peak[type].load(std::memory_order_relaxed);
+
+         for (std::size_t value=0; value<event_count; ++value)
+         {
+            auto calls = instance.retired[type][value][0] - instance.baseline[type][value][0];
+            auto bytes = instance.retired[type][value][1] - instance.baseline[type][value][1];
+
+            for (auto thread : instance.threads)
+            {
+               calls += thread->values[type][value][0].load(std::memory_order_relaxed);
+               bytes += thread->values[type][value][1].load(std::memory_order_relaxed);
+            }
+
+            report.events[value].calls = calls;
+            report.events[value].bytes = bytes;
+         }
+      }
+
+      return result;
+   }
+   // Starts the counts over from zero and the peaks over from the bytes live right now.
+   inline void reset() {
+      auto &instance = global();
+      std::lock_guard<std::mutex> lock(instance.mutex);
+
+      for (std::size_t type=0; type<max_types; ++type)
+      {
+         for (std::size_t value=0; value<event_count; ++value)
+         {
+            instance.baseline[type][value][0] = instance.retired[type][value][0];
+            instance.baseline[type][value][1] = instance.retired[type][value][1];
+
+            for (auto thread : instance.threads)
+            {
+               instance.baseline[type][value][0] += thread->values[type][value][0].load(std::memory_order_relaxed);
+               instance.baseline[type][value][1] += thread->values[type][value][1].load(std::memory_order_relaxed);
+            }
+         }
+
+         auto live = instance.live(type);
+         instance.peak[type].store(live > 0 ? static_cast<std::uint64_t>(live) : 0, std::memory_order_relaxed);
+      }
+   }
+
+   inline void set_sink(instrument::sink target) {
+      auto &instance = global();
+      std::lock_guard<std::mutex> lock(instance.mutex);
+
+      instance.sink = std::move(target);
+   }
+   // Hands a snapshot to the sink, if one is set.
+   inline void flush() {
+      instrument::sink target;
+
+      {
+         auto &instance = global();
+         std::lock_guard<std::mutex> lock(instance.mutex);
+
+         target = instance.sink;
+      }
+
+      if (target)
+         target(snapshot());
+   }
+#else
+   const bool enabled = false;
+
+   template <typename T>
+   inline void record(event, std::size_t) {}
+   template <typename T>
+   inline void record_live(std::int64_t) {}
+
+   inline std::vector<type_report> snapshot() { return {}; }
+   inline void reset() {}
+   inline void set_sink(instrument::sink) {}
+   inline void flush() {}
+#endif
+}
+}
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef __PTRTOOLS_IO_HPP
+#define __PTRTOOLS_IO_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <ptrtools/memory.hpp>
+
+#ifdef PTRTOOLS_HAS_MMAP
+#include <climits>
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
+
+namespace ptrtools
+{
+#ifdef PTRTOOLS_HAS_MMAP
+   using io_segment = ::iovec;
+
+#ifdef IOV_MAX
+   const std::size_t io_max_segments = IOV_MAX;
+#else
+   const std::size_t io_max_segments = 1024;
+#endif
+#else
+   struct io_segment
+   {
+      void *iov_base;
+      std::size_t iov_len;
+   };
+
+   const std::size_t io_max_segments = 1024;
+#endif
+
+   // Scatter/gather list over the buffers of any ptrtools pointer or view, so that a header, a
+   // flexible body and a few payload arrays can go to or come from a file descriptor in place,
+   // without first being cloned into one contiguous buffer. The list borrows the buffers: they
+   // have to outlive it and must not be reallocated while it is in use.
+   //
+   // add() takes buffers read-only and never detaches a shared buffer, so anything can be written
+   // out. Buffers that a read should fill go in through add_target(), which takes the mutable
+   // pointer. Lists longer than IOV_MAX are split across calls and partial transfers are resumed,
+   // so write() only returns once every byte is out.
+   class io_vector
+   {
+      std::vector<io_segment> _segments;
+      std::size_t _bytes = 0;
+      bool _readonly = false;
+
+      void push(void *data, std::size_t size, bool readonly) {
+         // empty buffers would make a zero-byte transfer look like end of file
+         if (size == 0)
+            return;
+
+         if (data == nullptr)
+            throw std::runtime_error("null pointer: attempting to add a null buffer to an I/O vector");
+
+         io_segment segment;
+         segment.iov_base = data;
+         segment.iov_len = size;
+
+         this->_segments.push_back(segment);
+         this->_bytes += size;
+         this->_readonly = this->_readonly || readonly;
+      }
+
+      // Runs call(segments, count, done) until every byte is transferred or the call reports end
+      // of file by transferring nothing.
+      template <typename Call>
+      std::size_t transfer(Call call) const {
+         if (this->_segments.empty())
+            return 0;
+
+#ifdef PTRTOOLS_HAS_MMAP
+         // the kernel may stop partway through a segment, so resume from a private copy
+         std::vector<io_segment> pending(this->_segments);
+         io_segment *segments = pending.data();
+         std::size_t count = pending.size();
+         std::size_t done = 0;
+
+         while (count > 0)
+         {
+            auto result = call(segments, static_cast<int>(std::min(count, io_max_segments)), done);
+
+            if (result < 0)
+            {
+               if (errno == EINTR)
+                  continue;
+
+               throw std::runtime_error("I/O error: the vectored transfer failed");
+            }
+
+            if (result == 0)
+               break;
+
+            auto transferred = static_cast<std::size_t>(result);
+            done += transferred;
+
+            for (; count > 0 && transferred >= segments->iov_len; ++segments, --count)
+               transferred -= segments->iov_len;
+
+            if (transferred > 0)
+            {
+               segments->iov_base = static_cast<std::uint8_t *>(segments->iov_base) + transferred;
+               segments->iov_len -= transferred;
+            }
+         }
+
+         return done;
+#else
+         (void)call;
+         throw std::runtime_error("unsupported platform: vectored I/O requires readv and writev");
+#endif
+      }
+
+   public:
+      io_vector() {}
+      explicit io_vector(std::size_t segments) { this->_segments.reserve(segments); }
+
+      template <typename... Buffers>
+      static io_vector of(const Buffers &... buffers) {
+         io_vector result(sizeof...(Buffers));
+
+         (result.add(buffers), ...);
+
+         return result;
+      }
+
+      io_vector &add(const void *data, std::size_t size) {
+         this->push(const_cast<void *>(data), size, true);
+
+         return *this;
+      }
+      // Any basic_ptr, array_ptr, struct_ptr, flexible_ptr or view, const or not. Only size()
+      // bytes are sent, so the spare capacity of a grown buffer is left out.
+      template <typename Buffer>
+      io_vector &add(const Buffer &buffer) {
+         return this->add(static_cast<const void *>(buffer.get()), buffer.size());
+      }
+      io_vector &add_target(void *data, std::size_t size) {
+         this->push(data, size, false);
+
+         return *this;
+      }
+      template <typename Buffer>
+      io_vector &add_target(Buffer &buffer) {
+         return this->add_target(static_cast<void *>(buffer.get()), buffer.size());
+      }
+
+      void clear() {
+         this->_segments.clear();
+         this->_bytes = 0;
+         this->_readonly = false;
+      }
+      void reserve(std::size_t segments) { this->_segments.reserve(segments); }
+
+      const io_segment *data() const { return this->_segments.data(); }
+      std::size_t size() const { return this->_segments.size(); }
+      std::size_t bytes() const { return this->_bytes; }
+      bool empty() const { return this->_segments.empty(); }
+      bool is_readonly() const { return this->_readonly; }
+
+      // Writes every buffer in order and returns the number of bytes written, which is bytes().
+      std::size_t write(int fd) const {
+#ifdef PTRTOOLS_HAS_MMAP
+         auto done = this->transfer([fd](const io_segment *segments, int count, std::size_t) {
+            return ::writev(fd, segments, count);
+         });
+#else
+         (void)fd;
+         auto done = this->transfer(0);
+#endif
+
+         if (done != this->_bytes)
+            throw std::runtime_error("I/O error: the descriptor stopped accepting data");
+
+         return done;
+      }
+      std::size_t write(int fd, std::uint64_t offset) const {
+#ifdef PTRTOOLS_HAS_MMAP
+         auto done = this->transfer([fd, offset](const io_segment *segments, int count, std::size_t done) {
+            return ::pwritev(fd, segments, count, static_cast<off_t>(offset + done));
+         });
+#else
+         (void)fd;
+         (void)offset;
+         auto done = this->transfer(0);
+#endif
+
+         if (done != this->_bytes)
+            throw std::runtime_error("I/O error: the descriptor stopped accepting data");
+
+         return done;
+      }
+      // Fills the buffers in order and returns the number of bytes read, which is short of
+      // bytes() only when end of file is reached first.
+      std::size_t read(int fd) const {
+         if (this->_readonly)
+            throw std::runtime_error("const conflict: attempting to read into a read-only buffer");
+
+#ifdef PTRTOOLS_HAS_MMAP
+         return this->transfer([fd](const io_segment *segments, int count, std::size_t) {
+            return ::readv(fd, segments, count);
+         });
+#else
+         (void)fd;
+         return this->transfer(0);
+#endif
+      }
+      std::size_t read(int fd, std::uint64_t offset) const {
+         if (this->_readonly)
+            throw std::runtime_error("const conflict: attempting to read into a read-only buffer");
+
+#ifdef PTRTOOLS_HAS_MMAP
+         return this->transfer([fd, offset](const io_segment *segments, int count, std::size_t done) {
+            return ::preadv(fd, segments, count, static_cast<off_t>(offset + done));
+         });
+#else
+         (void)fd;
+         (void)offset;
+         return this->transfer(0);
+#endif
+      }
+   };
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef __PTRTOOLS_ITERATOR_HPP
+#define __PTRTOOLS_ITERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include <ptrtools/policy.hpp>
+
+namespace ptrtools
+{
+   // Random-access iterator over elements laid out Stride bytes apart. When the stride matches
+   // sizeof(T) and the iterator walks forward it is a plain pointer walk and is tagged contiguous
+   // on C++20 and later.
+   template <typename T, std::size_t Stride, typename CheckPolicy=default_policy, bool Reverse=false>
+   class basic_iterator
+   {
+      static_assert(Stride > 0, "Stride cannot be zero");
+
+   public:
+      const static bool is_contiguous = (Stride == sizeof(T) && !Reverse);
+
+#if __cplusplus > 201703L
+      using iterator_category = typename std::conditional<is_contiguous, std::contiguous_iterator_tag, std::random_access_iterator_tag>::type;
+      using iterator_concept = iterator_category;
+#else
+      using iterator_category = std::random_access_iterator_tag;
+#endif
+      using difference_type = std::ptrdiff_t;
+      using value_type = typename std::remove_cv<T>::type;
+      using element_type = T;
+      using pointer = T *;
+      using reference = T &;
+
+      const static std::size_t stride = Stride;
+
+   private:
+      pointer _iter;
+
+      static pointer step(pointer ptr, difference_type count) {
+         if (Reverse)
+            count = -count;
+
+         if constexpr (Stride == sizeof(T))
+            return ptr + count;
+         else
+            return reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(ptr) + count * static_cast<difference_type>(Stride));
+      }
+
+   public:
+      basic_iterator() : _iter(nullptr) {}
+      explicit basic_iterator(pointer ptr) : _iter(ptr) {}
+      basic_iterator(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) : _iter(other._iter) {}
+      template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value && !std::is_const<U>::value>::type>
+      basic_iterator(const basic_iterator<U,Stride,CheckPolicy,Reverse> &other) : _iter(other.get()) {}
+      ~basic_iterator() {}
+
+      basic_iterator<T,Stride,CheckPolicy,Reverse> &operator=(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) {
+         this->_iter = other._iter;
+
+         return *this;
+      }
+      basic_iterator<T,Stride,CheckPolicy,Reverse> &operator+=(difference_type count) {
+         CheckPolicy::check(this->_iter != nullptr, "null pointer: attempting to advance an iterator on a null pointer");
+
+         this->_iter = step(this->_iter, count);
+
+         return *this;
+      }
+      basic_iterator<T,Stride,CheckPolicy,Reverse> &operator-=(difference_type count) { return *this += -count; }
+      basic_iterator<T,Stride,CheckPolicy,Reverse> &operator++() { return *this += 1; }
+      basic_iterator<T,Stride,CheckPolicy,Reverse> &operator--() { return *this -= 1; }
+      basic_iterator<T,Stride,CheckPolicy,Reverse> operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+      basic_iterator<T,Stride,CheckPolicy,Reverse> operator--(int) { auto tmp = *this; --(*this); return tmp; }
+      basic_iterator<T,Stride,CheckPolicy,Reverse> operator+(difference_type count) const { auto tmp = *this; tmp += count; return tmp; }
+      basic_iterator<T,Stride,CheckPolicy,Reverse> operator-(difference_type count) const { auto tmp = *this; tmp -= count; return tmp; }
+      friend basic_iterator<T,Stride,CheckPolicy,Reverse> operator+(difference_type count, const basic_iterator<T,Stride,CheckPolicy,Reverse> &iter) { return iter + count; }
+      difference_type operator-(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) const {
+         auto delta = static_cast<difference_type>(reinterpret_cast<std::uintptr_t>(this->_iter) - reinterpret_cast<std::uintptr_t>(other._iter)) / static_cast<difference_type>(Stride);
+
+         return Reverse ? -delta : delta;
+      }
+
+      bool operator==(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) const { return this->_iter == other._iter; }
+      bool operator!=(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) const { return this->_iter != other._iter; }
+      bool operator<(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) const { return (*this - other) < 0; }
+      bool operator>(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) const { return other < *this; }
+      bool operator<=(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) const { return !(other < *this); }
+      bool operator>=(const basic_iterator<T,Stride,CheckPolicy,Reverse> &other) const { return !(*this < other); }
+
+      reference operator*() const {
+         CheckPolicy::check(this->_iter != nullptr, "null pointer: attempting to dereference an iterator on a null pointer");
+
+         return *this->_iter;
+      }
+      pointer operator->() const {
+         CheckPolicy::check(this->_iter != nullptr, "null pointer: attempting to dereference an iterator on a null pointer");
+
+         return this->_iter;
+      }
+      reference operator[](difference_type index) const { return *(*this + index); }
+
+      pointer get() const { return this->_iter; }
+   };
+
+   // Random-access iterator whose stride is only known at runtime, e.g. one field of every record
+   // in an array of structs.
+   template <typename T, typename CheckPolicy=default_policy>
+   class strided_iterator
+   {
+   public:
+      using iterator_category = std::random_access_iterator_tag;
+      using difference_type = std::ptrdiff_t;
+      using value_type = typename std::remove_cv<T>::type;
+      using element_type = T;
+      using pointer = T *;
+      using reference = T &;
+
+   private:
+      pointer _iter;
+      std::size_t _stride;
+
+   public:
+      strided_iterator() : _iter(nullptr), _stride(sizeof(T)) {}
+      strided_iterator(pointer ptr, std::size_t stride) : _iter(ptr), _stride(stride) {}
+      template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value && !std::is_const<U>::value>::type>
+      strided_iterator(const strided_iterator<U,CheckPolicy> &other) : _iter(other.get()), _stride(other.stride()) {}
+
+      strided_iterator<T,CheckPolicy> &operator+=(difference_type count) {
+         CheckPolicy::check(this->_iter != nullptr, "null pointer: attempting to advance an iterator on a null pointer");
+
+         this->_iter = reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(this->_iter) + count * static_cast<difference_type>(this->_stride));
+
+         return *this;
+      }
+      strided_iterator<T,CheckPolicy> &operator-=(difference_type count) { return *this += -count; }
+      strided_iterator<T,CheckPolicy> &operator++() { return *this += 1; }
+      strided_iterator<T,CheckPolicy> &operator--() { return *this -= 1; }
+      strided_iterator<T,CheckPolicy> operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+      strided_iterator<T,CheckPolicy> operator--(int) { auto tmp = *this; --(*this); return tmp; }
+      strided_iterator<T,CheckPolicy> operator+(difference_type count) const { auto tmp = *this; tmp += count; return tmp; }
+      strided_iterator<T,CheckPolicy> operator-(difference_type count) const { auto tmp = *this; tmp -= count; return tmp; }
+      friend strided_iterator<T,CheckPolicy> operator+(difference_type count, const strided_iterator<T,CheckPolicy> &iter) { return iter + count; }
+      difference_type operator-(const strided_iterator<T,CheckPolicy> &other) const {
+         return static_cast<difference_type>(reinterpret_cast<std::uintptr_t>(this->_iter) - reinterpret_cast<std::uintptr_t>(other._iter)) / static_cast<difference_type>(this->_stride);
+      }
+
+      bool operator==(const strided_iterator<T,CheckPolicy> &other) const { return this->_iter == other._iter; }
+      bool operator!=(const strided_iterator<T,CheckPolicy> &other) const { return this->_iter != other._iter; }
+      bool operator<(const strided_iterator<T,CheckPolicy> &other) const { return (*this - other) < 0; }
+      bool operator>(const strided_iterator<T,CheckPolicy> &other) const { return other < *this; }
+      bool operator<=(const strided_iterator<T,CheckPolicy> &other) const { return !(other < *this); }
+      bool operator>=(const strided_iterator<T,CheckPolicy> &other) const { return !(*this < other); }
+
+      reference operator*() const {
+         CheckPolicy::check(this->_iter != nullptr, "null pointer: attempting to dereference an iterator on a null pointer");
+
+         return *this->_iter;
+      }
+      pointer operator->() const { return &**this; }
+      reference operator[](difference_type index) const { return *(*this + index); }
+
+      pointer get() const { return this->_iter; }
+      std::size_t stride() const { return this->_stride; }
+   };
+}
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef __PTRTOOLS_MAPPED_HPP
+#define __PTRTOOLS_MAPPED_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <ptrtools/array.hpp>
+#include <ptrtools/basic.hpp>
+#include <ptrtools/flexible.hpp>
+#include <ptrtools/memory.hpp>
+#include <ptrtools/policy.hpp>
+#include <ptrtools/struct.hpp>
+#include <ptrtools/view.hpp>
+
+#ifdef PTRTOOLS_HAS_MMAP
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace ptrtools
+{
+   // How a file is mapped: read_only pages cannot be written, copy_on_write pages can be written
+   // without touching the file and read_write pages are shared with the file and other mappings.
+   enum class map_mode
+   {
+      read_only,
+      copy_on_write,
+      read_write
+   };
+
+   enum class access_pattern
+   {
+      normal,
+      sequential,
+      random,
+      will_need,
+      dont_need
+   };
+
+   // Owns a mapping of a whole file. The pointers and views it hands out borrow the mapping, so
+   // struct_ptr and flexible_ptr can overlay the file without copying it; only the pages that are
+   // actually touched get read in. Pointers over a read_only mapping are const.
+   class mapped_file
+   {
+      std::uint8_t *_ptr = nullptr;
+      std::size_t _size = 0;
+      map_mode _mode = map_mode::read_only;
+      bool _open = false;
+
+      std::size_t checked_size(std::size_t offset, std::size_t size) const {
+         if (!this->_open)
+            throw std::runtime_error("mapping error: the file is not mapped");
+
+         if (offset > this->_size || size > this->_size - offset)
+            throw std::runtime_error("out of bounds: the given range exceeds the mapped file");
+
+         return size;
+      }
+      // Typed overlays are handed out in place, so they have to start on the type's boundary.
+      template <typename T>
+      void checked_alignment(std::size_t offset) const {
+         if (reinterpret_cast<std::uintptr_t>(this->_ptr + offset) % alignof(T) != 0)
+            throw std::runtime_error("invalid alignment: the given offset is not aligned to the type boundary");
+      }
+
+   public:
+      const static std::size_t npos = static_cast<std::size_t>(-1);
+
+      mapped_file() {}
+      mapped_file(const std::string &path, map_mode mode=map_mode::read_only) { this->open(path, mode); }
+      mapped_file(const mapped_file &other) = delete;
+      mapped_file(mapped_file &&other) : _ptr(other._ptr), _size(other._size), _mode(other._mode), _open(other._open) {
+         other._ptr = nullptr;
+         other._size = 0;
+         other._open = false;
+      }
+      ~mapped_file() {
+         if (this->_open)
+            this->close();
+      }
+
+      mapped_file &operator=(const mapped_file &other) = delete;
+      mapped_file &operator=(mapped_file &&other) {
+         if (this == &other)
+            return *this;
+
+         if (this->_open)
+            this->close();
+
+         this->_ptr = other._ptr;
+         this->_size = other._size;
+         this->_mode = other._mode;
+         this->_open = other._open;
+
+         other._ptr = nullptr;
+         other._size = 0;
+         other._open = false;
+
+         return *this;
+      }
+
+      void open(const std::string &path, map_mode mode=map_mode::read_only) {
+#ifdef PTRTOOLS_HAS_MMAP
+         if (this->_open)
+            this->close();
+
+         int fd = ::open(path.c_str(), mode == map_mode::read_write ? O_RDWR : O_RDONLY);
+
+         if (fd < 0)
+            throw std::runtime_error("mapping error: could not open the file");
+
+         struct stat info;
+
+         if (fstat(fd, &info) != 0)
+         {
+            ::close(fd);
+            throw std::runtime_error("mapping error: could not query the file size");
+         }
+
+         auto size = static_cast<std::size_t>(info.st_size);
+         void *result = nullptr;
+
+         // an empty file cannot be mapped, it simply yields a null pointer of size zero
+         if (size > 0)
+         {
+            int protection = mode == map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+            int flags = mode == map_mode::read_write ? MAP_SHARED : MAP_PRIVATE;
+
+            result = mmap(nullptr, size, protection, flags, fd, 0);
+         }
+
+         ::close(fd);
+
+         if (result == MAP_FAILED)
+            throw std::runtime_error("mapping error: could not map the file");
+
+         this->_ptr = static_cast<std::uint8_t *>(result);
+         this->_size = size;
+         this->_mode = mode;
+         this->_open = true;
+#else
+         (void)path;
+         (void)mode;
+         throw std::runtime_error("unsupported platform: mapped files require mmap");
+#endif
+      }
+      void close() {
+         if (!this->_open)
+            throw std::runtime_error("mapping error: the file is not mapped");
+
+         if (this->_ptr != nullptr)
+            unmap_pages(this->_ptr, this->_size);
+
+         this->_ptr = nullptr;
+         this->_size = 0;
+         this->_open = false;
+      }
+
+      void advise(access_pattern pattern, std::size_t offset=0, std::size_t size=npos) {
+         if (size == npos)
+            size = this->_size - std::min(offset, this->_size);
+
+         this->checked_size(offset, size);
+
+         if (size == 0)
+            return;
+
+#ifdef PTRTOOLS_HAS_MMAP
+         int advice = MADV_NORMAL;
+
+         switch (pattern)
+         {
+         case access_pattern::normal: advice = MADV_NORMAL; break;
+         case access_pattern::sequential: advice = MADV_SEQUENTIAL; break;
+         case access_pattern::random: advice = MADV_RANDOM; break;
+         case access_pattern::will_need: advice = MADV_WILLNEED; break;
+         case access_pattern::dont_need: advice = MADV_DONTNEED; break;
+         }
+
+         // madvise wants a page-aligned start, so widen the range down to its first page
+         auto start = offset - offset % page_size();
+
+         if (madvise(this->_ptr + start, size + (offset - start), advice) != 0)
+            throw std::runtime_error("mapping error: the access hint was rejected");
+#else
+         (void)pattern;
+#endif
+      }
+      void sync(bool async=false) {
+         if (!this->_open)
+            throw std::runtime_error("mapping error: the file is not mapped");
+
+         if (this->_mode != map_mode::read_write || this->_ptr == nullptr)
+            return;
+
+#ifdef PTRTOOLS_HAS_MMAP
+         if (msync(this->_ptr, this->_size, async ? MS_ASYNC : MS_SYNC) != 0)
+            throw std::runtime_error("mapping error: could not flush the mapping to the file");
+#else
+         (void)async;
+#endif
+      }
+
+      bool is_open() const { return this->_open; }
+      bool is_const() const { return this->_mode == map_mode::read_only; }
+      map_mode mode() const { return this->_mode; }
+      std::size_t size() const { return this->_size; }
+      const std::uint8_t *data() const { return this->_ptr; }
+
+      template <typename CheckPolicy=default_policy>
+      basic_ptr<std::uint8_t,1,1,std::allocator<std::uint8_t>,CheckPolicy> ptr(std::size_t offset=0, std::size_t size=npos) const {
+         if (size == npos)
+            size = this->_size - std::min(offset, this->_size);
+
+         this->checked_size(offset, size);
+
+         if (this->is_const())
+            return basic_ptr<std::uint8_t,1,1,std::allocator<std::uint8_t>,CheckPolicy>(static_cast<const std::uint8_t *>(this->_ptr + offset), size);
+         else
+            return basic_ptr<std::uint8_t,1,1,std::allocator<std::uint8_t>,CheckPolicy>(this->_ptr + offset, size);
+      }
+      template <typename T, typename CheckPolicy=default_policy>
+      array_ptr<T,std::allocator<std::uint8_t>,CheckPolicy> array(std::size_t offset=0, std::size_t elements=npos) const {
+         const auto stride = array_ptr<T,std::allocator<std::uint8_t>,CheckPolicy>::type_stride;
+
+         if (elements == npos)
+            elements = (this->_size - std::min(offset, this->_size)) / stride;
+
+         this->checked_size(offset, elements * stride);
+         this->template checked_alignment<T>(offset);
+
+         if (this->is_const())
+            return array_ptr<T,std::allocator<std::uint8_t>,CheckPolicy>(reinterpret_cast<const T *>(this->_ptr + offset), elements);
+         else
+            return array_ptr<T,std::allocator<std::uint8_t>,CheckPolicy>(reinterpret_cast<T *>(this->_ptr + offset), elements);
+      }
+      template <typename T, typename CheckPolicy=default_policy>
+      struct_ptr<T,std::allocator<std::uint8_t>,CheckPolicy> struct_at(std::size_t offset=0, std::size_t size=sizeof(T)) const {
+         this->checked_size(offset, size);
+         this->template checked_alignment<T>(offset);
+
+         if (this->is_const())
+            return struct_ptr<T,std::allocator<std::uint8_t>,CheckPolicy>(reinterpret_cast<const T *>(this->_ptr + offset), size);
+         else
+            return struct_ptr<T,std::allocator<std::uint8_t>,CheckPolicy>(reinterpret_cast<T *>(this->_ptr + offset), size);
+      }
+      template <typename T, typename FlexibleType, std::size_t StructElements=1, typename CheckPolicy=default_policy>
+      flexible_ptr<T,FlexibleType,StructElements,std::allocator<std::uint8_t>,CheckPolicy> flexible_at(std::size_t offset, std::size_t elements) const {
+         using flexible_decl = flexible_ptr<T,FlexibleType,StructElements,std::allocator<std::uint8_t>,CheckPolicy>;
+
+         this->checked_size(offset, sizeof(T) - sizeof(FlexibleType) * StructElements + sizeof(FlexibleType) * elements);
+         this->template checked_alignment<T>(offset);
+
+         if (this->is_const())
+            return flexible_decl(reinterpret_cast<const T *>(this->_ptr + offset), elements);
+         else
+            return flexible_decl(reinterpret_cast<T *>(this->_ptr + offset), elements);
+      }
+
+      basic_view<std::uint8_t,1,1> view(std::size_t offset=0, std::size_t size=npos) {
+         if (this->is_const())
+            throw std::runtime_error("const conflict: attempting to get a mutable view of a read-only mapping");
+
+         if (size == npos)
+            size = this->_size - std::min(offset, this->_size);
+
+         this->checked_size(offset, size);
+
+         return basic_view<std::uint8_t,1,1>(this->_ptr + offset, size);
+      }
+      basic_view<const std::uint8_t,1,1> const_view(std::size_t offset=0, std::size_t size=npos) const {
+         if (size == npos)
+            size = this->_size - std::min(offset, this->_size);
+
+         this->checked_size(offset, size);
+
+         return basic_view<const std::uint8_t,1,1>(this->_ptr + offset, size);
+      }
+   };
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef __PTRTOOLS_MEMORY_HPP
+#define __PTRTOOLS_MEMORY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define PTRTOOLS_HAS_MMAP
+#endif
+
+namespace ptrtools
+{
+   // How the contents of a freshly allocated block are initialized. lazily_zeroed asks for memory
+   // that reads as zero without paying for a memset up front: large blocks come straight from
+   // anonymous mappings, whose pages the kernel zero-fills on first touch.
+   enum class allocation_mode
+   {
+      uninitialized,
+      zeroed,
+      lazily_zeroed
+   };
+
+   // Huge pages for large tables: transparent asks the kernel to back a huge-page-aligned mapping
+   // with huge pages when it can, hugetlb draws from the reserved hugetlbfs pool and falls back to
+   // transparent when the pool is empty.
+   enum class huge_page_mode
+   {
+      transparent,
+      hugetlb
+   };
+
+   const std::size_t lazy_mapping_threshold = 256 * 1024;
+   const std::size_t huge_page_size = 2 * 1024 * 1024;
+
+#ifdef __STDCPP_DEFAULT_NEW_ALIGNMENT__
+   const std::size_t default_new_alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+   const std::size_t default_new_alignment = alignof(std::max_align_t);
+#endif
+
+   // The alignment an allocator guarantees for the blocks it returns. Allocators can advertise it
+   // with a static alignment member; otherwise only alignof(value_type) is promised, except by
+   // std::allocator, which goes through operator new.
+   template <typename Allocator, typename = void>
+   struct allocator_alignment
+   {
+      const static std::size_t value = alignof(typename Allocator::value_type);
+   };
+
+   template <typename T>
+   struct allocator_alignment<std::allocator<T>, void>
+   {
+      const static std::size_t value = alignof(T) > default_new_alignment ? alignof(T) : default_new_alignment;
+   };
+
+   template <typename Allocator>
+   struct allocator_alignment<Allocator, std::void_t<decltype(Allocator::alignment)>>
+   {
+      const static std::size_t value = Allocator::alignment;
+   };
+
+   inline bool pages_available() {
+#ifdef PTRTOOLS_HAS_MMAP
+      return true;
+#else
+      return false;
+#endif
+   }
+   inline std::size_t page_size() {
+#ifdef PTRTOOLS_HAS_MMAP
+      static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+      return size;
+#else
+      return 4096;
+#endif
+   }
+   inline void *map_pages(std::size_t size) {
+#ifdef PTRTOOLS_HAS_MMAP
+      auto result = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (result == MAP_FAILED)
+         return nullptr;
+
+      return result;
+#else
+      (void)size;
+      return nullptr;
+#endif
+   }
+   inline void unmap_pages(void *ptr, std::size_t size) {
+#ifdef PTRTOOLS_HAS_MMAP
+      munmap(ptr, size);
+#else
+      (void)ptr;
+      (void)size;
+#endif
+   }
+   inline void *map_huge_pages(std::size_t size, huge_page_mode mode) {
+#ifdef PTRTOOLS_HAS_MMAP
+#ifdef MAP_HUGETLB
+      if (mode == huge_page_mode::hugetlb)
+      {
+         auto result = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+         if (result != MAP_FAILED)
+            return result;
+      }
+#endif
+      // over-map by one huge page and trim both ends so the block starts on a huge page boundary
+      auto span = size + huge_page_size;
+      auto raw = static_cast<std::uint8_t *>(map_pages(span));
+
+      if (raw == nullptr)
+         return nullptr;
+
+      auto head = (huge_page_size - reinterpret_cast<std::uintptr_t>(raw) % huge_page_size) % huge_page_size;
+      auto tail = span - head - size;
+
+      if (head > 0)
+         unmap_pages(raw, head);
+
+      if (tail > 0)
+         unmap_pages(raw + head + size, tail);
+
+#ifdef MADV_HUGEPAGE
+      madvise(raw + head, size, MADV_HUGEPAGE);
+#endif
+
+      return raw + head;
+#else
+      (void)size;
+      (void)mode;
+      return nullptr;
+#endif
+   }
+   inline void *remap_pages(void *ptr, std::size_t old_size, std::size_t new_size) {
+#if defined(__linux__)
+      auto result = mremap(ptr, old_size, new_size, MREMAP_MAYMOVE);
+
+      if (result == MAP_FAILED)
+         return nullptr;
+
+      return result;
+#else
+      auto result = map_pages(new_size);
+
+      if (result == nullptr)
+         return nullptr;
+
+      std::memcpy(result, ptr, std::min(old_size, new_size));
+      unmap_pages(ptr, old_size);
+
+      return result;
+#endif
+   }
+}
+
+#endif
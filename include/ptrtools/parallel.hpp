@@ -0,0 +1,457 @@
+#ifndef __PTRTOOLS_PARALLEL_HPP
+#define __PTRTOOLS_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ptrtools/simd.hpp>
+
+namespace ptrtools
+{
+   // Small work-stealing pool. Every worker owns a queue: tasks submitted from a worker go to the
+   // back of its own queue and it runs them newest first, while idle workers steal the oldest
+   // task from the front of someone else's queue. Tasks submitted from outside are dealt out
+   // round robin.
+   class thread_pool
+   {
+      struct task_queue
+      {
+         std::mutex mutex;
+         std::deque<std::function<void()>> tasks;
+      };
+
+      std::vector<std::unique_ptr<task_queue>> _queues;
+      std::vector<std::thread> _threads;
+      std::mutex _sleep_mutex;
+      std::condition_variable _wake;
+      std::atomic<std::size_t> _pending{0};
+      std::atomic<std::size_t> _next{0};
+      bool _stopping = false;
+
+      static std::pair<const thread_pool *, std::size_t> &current() {
+         thread_local std::pair<const thread_pool *, std::size_t> worker{nullptr, 0};
+         return worker;
+      }
+
+      bool pop(std::size_t index, std::function<void()> &task) {
+         {
+            auto &own = *this->_queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+
+            if (!own.tasks.empty())
+            {
+               task = std::move(own.tasks.back());
+               own.tasks.pop_back();
+               return true;
+            }
+         }
+
+         for (std::size_t offset=1; offset<this->_queues.size(); ++offset)
+         {
+            auto &victim = *this->_queues[(index + offset) % this->_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+
+            if (!victim.tasks.empty())
+            {
+               task = std::move(victim.tasks.front());
+               victim.tasks.pop_front();
+               return true;
+            }
+         }
+
+         return false;
+      }
+      void work(std::size_t index) {
+         current() = std::make_pair(this, index);
+
+         for (;;)
+         {
+            std::function<void()> task;
+
+            if (this->pop(index, task))
+            {
+               --this->_pending;
+               task();
+               continue;
+            }
+
+            std::unique_lock<std::mutex> lock(this->_sleep_mutex);
+            this->_wake.wait(lock, [this]() { return this->_stopping || this->_pending.load() > 0; });
+
+            if (this->_stopping && this->_pending.load() == 0)
+               return;
+         }
+      }
+
+   public:
+      static std::size_t default_threads() {
+         auto hardware = std::thread::hardware_concurrency();
+
+         // the thread waiting on a parallel algorithm works too, so leave a core for it
+         return hardware > 1 ? hardware - 1 : 1;
+      }
+
+      explicit thread_pool(std::size_t threads=default_threads()) {
+         if (threads == 0)
+            throw std::runtime_error("invalid argument: a thread pool needs at least one thread");
+
+         for (std::size_t index=0; index<threads; ++index)
+            this->_queues.push_back(std::make_unique<task_queue>());
+
+         for (std::size_t index=0; index<threads; ++index)
+            this->_threads.emplace_back(&thread_pool::work, this, index);
+      }
+      thread_pool(const thread_pool &other) = delete;
+      ~thread_pool() {
+         {
+            std::lock_guard<std::mutex> lock(this->_sleep_mutex);
+            this->_stopping = true;
+         }
+
+         this->_wake.notify_all();
+
+         for (auto &thread : this->_threads)
+            thread.join();
+      }
+
+      thread_pool &operator=(const thread_pool &other) = delete;
+
+      static thread_pool &global() {
+         // never destroyed: joining the workers during static teardown could deadlock with other statics
+         static thread_pool *pool = new thread_pool();
+         return *pool;
+      }
+
+      std::size_t size() const { return this->_threads.size(); }
+
+      void submit(std::function<void()> task) {
+         auto &worker = current();
+         auto index = worker.first == this ? worker.second : this->_next++ % this->_queues.size();
+
+         // count the task before it becomes visible so a worker that pops it never underflows
+         {
+            std::lock_guard<std::mutex> lock(this->_sleep_mutex);
+            ++this->_pending;
+         }
+
+         {
+            auto &queue = *this->_queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+         }
+
+         this->_wake.notify_one();
+      }
+   };
+
+namespace parallel
+{
+   // Anything with a submit(std::function<void()>) member can run the parallel algorithms. An
+   // executor with a size() member is asked how many tasks it can run at once.
+   template <typename Executor, typename = void>
+   struct is_executor : std::false_type {};
+
+   template <typename Executor>
+   struct is_executor<Executor,std::void_t<decltype(std::declval<Executor &>().submit(std::function<void()>()))>> : std::true_type {};
+
+   template <typename Executor, typename = void>
+   struct has_concurrency : std::false_type {};
+
+   template <typename Executor>
+   struct has_concurrency<Executor,std::void_t<decltype(std::declval<const Executor &>().size())>> : std::true_type {};
+
+   const static std::size_t cache_line = 64;
+   const static std::size_t default_grain_bytes = 64 * 1024;
+
+   template <typename Executor>
+   std::size_t concurrency(const Executor &executor) {
+      if constexpr (has_concurrency<Executor>::value)
+         return executor.size();
+      else
+      {
+         (void)executor;
+         return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+      }
+   }
+
+   // Splits [0, n) into chunks of chunk_size elements, except that the first chunk also takes
+   // the lead elements so that every later chunk starts on a cache line, and runs fn(begin, end)
+   // on each of them. The calling thread claims chunks too, then waits for the ones still in
+   // flight; the first exception thrown by fn makes the remaining chunks no-ops and is rethrown.
+   template <typename Executor, typename Function>
+   void for_chunks(Executor &executor, std::size_t n, std::size_t chunk_size, Function &&fn, std::size_t lead=0) {
+      if (n == 0)
+         return;
+
+      if (chunk_size == 0)
+         throw std::runtime_error("invalid argument: the chunk size cannot be zero");
+
+      auto chunks = n <= lead ? 1 : (n - lead + chunk_size - 1) / chunk_size;
+
+      if (chunks == 1)
+      {
+         fn(std::size_t(0), n);
+         return;
+      }
+
+      struct shared_state
+      {
+         std::atomic<std::size_t> next{0};
+         std::atomic<std::size_t> finished{0};
+         std::atomic<bool> cancelled{false};
+         std::size_t chunks;
+         std::mutex mutex;
+         std::condition_variable done;
+         std::exception_ptr error;
+      };
+
+      auto state = std::make_shared<shared_state>();
+      state->chunks = chunks;
+
+      // helpers only dereference fn after claiming a chunk, which cannot happen once this call has
+      // returned, so a helper that starts late never touches the caller's stack
+      auto body = &fn;
+      auto run = [state, body, n, chunk_size, lead]() {
+         for (;;)
+         {
+            auto chunk = state->next++;
+
+            if (chunk >= state->chunks)
+               return;
+
+            auto begin = chunk == 0 ? std::size_t(0) : lead + chunk * chunk_size;
+            auto end = std::min(n, lead + (chunk + 1) * chunk_size);
+
+            try
+            {
+               if (!state->cancelled)
+                  (*body)(begin, end);
+            }
+            catch (...)
+            {
+               std::lock_guard<std::mutex> lock(state->mutex);
+
+               if (!state->error)
+                  state->error = std::current_exception();
+
+               state->cancelled = true;
+            }
+
+            if (++state->finished == state->chunks)
+            {
+               std::lock_guard<std::mutex> lock(state->mutex);
+               state->done.notify_all();
+            }
+         }
+      };
+
+      auto helpers = std::min(concurrency(executor), chunks - 1);
+
+      for (std::size_t i=0; i<helpers; ++i)
+         executor.submit(run);
+
+      run();
+
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->done.wait(lock, [&state]() { return state->finished.load() == state->chunks; });
+
+      if (state->error)
+         std::rethrow_exception(state->error);
+   }
+
+   template <typename Range>
+   std::size_t stride_of(const Range &range) { (void)range; return Range::type_stride; }
+
+   template <typename Pointer>
+   Pointer element_at(Pointer base, std::size_t stride, std::size_t index) {
+      using byte_pointer = typename std::conditional<std::is_const<typename std::remove_pointer<Pointer>::type>::value, const std::uint8_t *, std::uint8_t *>::type;
+
+      return reinterpret_cast<Pointer>(reinterpret_cast<byte_pointer>(base) + index * stride);
+   }
+
+   // Chunk length and cache line lead for a range: chunks cover grain elements (or about 64 KiB
+   // when grain is zero), rounded to whole cache lines where the stride allows it.
+   template <typename Executor, typename Range>
+   std::pair<std::size_t,std::size_t> chunking(const Executor &executor, const Range &range, std::size_t grain) {
+      auto stride = stride_of(range);
+      auto elements = range.elements();
+      auto chunk = grain;
+
+      if (chunk == 0)
+      {
+         chunk = std::max<std::size_t>(default_grain_bytes / stride, 1);
+
+         // still give every thread a few chunks to balance uneven work
+         auto balanced = elements / (concurrency(executor) * 4 + 1);
+
+         if (balanced > 0 && balanced < chunk)
+            chunk = balanced;
+      }
+
+      std::size_t lead = 0;
+
+      if (cache_line % stride == 0)
+      {
+         auto per_line = cache_line / stride;
+         auto address = reinterpret_cast<std::uintptr_t>(range.get());
+
+         chunk = (chunk + per_line - 1) / per_line * per_line;
+
+         if (address % stride == 0)
+            lead = ((cache_line - address % cache_line) % cache_line) / stride;
+      }
+
+      return std::make_pair(chunk, lead);
+   }
+
+   template <typename Executor, typename Range, typename Function, typename = typename std::enable_if<is_executor<Executor>::value>::type>
+   void for_each(Executor &executor, Range &range, Function fn, std::size_t grain=0) {
+      auto base = range.get();
+      auto stride = stride_of(range);
+      auto chunk = chunking(executor, range, grain);
+
+      for_chunks(executor, range.elements(), chunk.first, [base, stride, &fn](std::size_t begin, std::size_t end) {
+         for (auto i=begin; i<end; ++i)
+            fn(*element_at(base, stride, i));
+      }, chunk.second);
+   }
+   template <typename Range, typename Function, typename = typename std::enable_if<!is_executor<Range>::value>::type>
+   void for_each(Range &range, Function fn, std::size_t grain=0) {
+      for_each(thread_pool::global(), range, fn, grain);
+   }
+
+   // out[i] = fn(in[i]) for every element of in; out must hold at least as many elements.
+   template <typename Executor, typename InRange, typename OutRange, typename Function, typename = typename std::enable_if<is_executor<Executor>::value>::type>
+   void transform(Executor &executor, const InRange &in, OutRange &out, Function fn, std::size_t grain=0) {
+      if (out.elements() < in.elements())
+         throw std::runtime_error("out of bounds: the output range is smaller than the input range");
+
+      auto in_base = in.get();
+      auto out_base = out.get();
+      auto in_stride = stride_of(in);
+      auto out_stride = stride_of(out);
+      auto chunk = chunking(executor, out, grain);
+
+      for_chunks(executor, in.elements(), chunk.first, [in_base, out_base, in_stride, out_stride, &fn](std::size_t begin, std::size_t end) {
+         for (auto i=begin; i<end; ++i)
+            *element_at(out_base, out_stride, i) = fn(*element_at(in_base, in_stride, i));
+      }, chunk.second);
+   }
+   template <typename InRange, typename OutRange, typename Function, typename = typename std::enable_if<!is_executor<InRange>::value>::type>
+   void transform(const InRange &in, OutRange &out, Function fn, std::size_t grain=0) {
+      transform(thread_pool::global(), in, out, fn, grain);
+   }
+
+   // Folds every element into init with op, which must be associative. Chunks are reduced
+   // independently and their results combined in order, so the result does not depend on
+   // scheduling.
+   template <typename Executor, typename Range, typename T, typename Operation, typename = typename std::enable_if<is_executor<Executor>::value>::type>
+   T reduce(Executor &executor, const Range &range, T init, Operation op, std::size_t grain=0) {
+      auto base = range.get();
+      auto stride = stride_of(range);
+      auto elements = range.elements();
+      auto chunk = chunking(executor, range, grain);
+      auto chunks = elements <= chunk.second ? 1 : (elements - chunk.second + chunk.first - 1) / chunk.first;
+      std::vector<std::optional<T>> partials(chunks);
+
+      if (elements == 0)
+         return init;
+
+      for_chunks(executor, elements, chunk.first, [base, stride, &op, &partials, &chunk](std::size_t begin, std::size_t end) {
+         T partial = *element_at(base, stride, begin);
+
+         for (auto i=begin+1; i<end; ++i)
+            partial = op(partial, *element_at(base, stride, i));
+
+         partials[begin == 0 ? 0 : (begin - chunk.second) / chunk.first] = std::move(partial);
+      }, chunk.second);
+
+      for (auto &partial : partials)
+         if (partial)
+            init = op(init, *partial);
+
+      return init;
+   }
+   template <typename Range, typename T, typename Operation, typename = typename std::enable_if<!is_executor<Range>::value>::type>
+   T reduce(const Range &range, T init, Operation op, std::size_t grain=0) {
+      return reduce(thread_pool::global(), range, init, op, grain);
+   }
+   template <typename Range, typename T>
+   T reduce(const Range &range, T init) {
+      return reduce(thread_pool::global(), range, init, std::plus<T>());
+   }
+
+   template <typename Executor, typename Range, typename T, typename = typename std::enable_if<is_executor<Executor>::value>::type>
+   void fill(Executor &executor, Range &range, const T &value, std::size_t grain=0) {
+      using value_type = typename Range::value_type;
+
+      auto base = range.get();
+      auto stride = stride_of(range);
+      auto chunk = chunking(executor, range, grain);
+      value_type fill_value = value;
+
+      for_chunks(executor, range.elements(), chunk.first, [base, stride, &fill_value](std::size_t begin, std::size_t end) {
+         if (stride == sizeof(value_type))
+            simd::fill(base + begin, end - begin, fill_value);
+         else
+            for (auto i=begin; i<end; ++i)
+               *element_at(base, stride, i) = fill_value;
+      }, chunk.second);
+   }
+   template <typename Range, typename T, typename = typename std::enable_if<!is_executor<Range>::value>::type>
+   void fill(Range &range, const T &value, std::size_t grain=0) {
+      fill(thread_pool::global(), range, value, grain);
+   }
+
+   // Copies every element of source into the front of destination.
+   template <typename Executor, typename InRange, typename OutRange, typename = typename std::enable_if<is_executor<Executor>::value>::type>
+   void copy(Executor &executor, const InRange &source, OutRange &destination, std::size_t grain=0) {
+      using value_type = typename OutRange::value_type;
+
+      if (destination.elements() < source.elements())
+         throw std::runtime_error("out of bounds: the destination range is smaller than the source range");
+
+      auto in_base = source.get();
+      auto out_base = destination.get();
+      auto in_stride = stride_of(source);
+      auto out_stride = stride_of(destination);
+      auto chunk = chunking(executor, destination, grain);
+      auto contiguous = in_stride == sizeof(value_type) && out_stride == sizeof(value_type) && std::is_same<typename InRange::value_type,value_type>::value;
+
+      for_chunks(executor, source.elements(), chunk.first, [in_base, out_base, in_stride, out_stride, contiguous](std::size_t begin, std::size_t end) {
+         if constexpr (std::is_trivially_copyable<value_type>::value)
+         {
+            if (contiguous)
+            {
+               std::memcpy(static_cast<void *>(out_base + begin), static_cast<const void *>(in_base + begin), (end - begin) * sizeof(value_type));
+               return;
+            }
+         }
+
+         for (auto i=begin; i<end; ++i)
+            *element_at(out_base, out_stride, i) = *element_at(in_base, in_stride, i);
+      }, chunk.second);
+   }
+   template <typename InRange, typename OutRange, typename = typename std::enable_if<!is_executor<InRange>::value>::type>
+   void copy(const InRange &source, OutRange &destination, std::size_t grain=0) {
+      copy(thread_pool::global(), source, destination, grain);
+   }
+}
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __PTRTOOLS_PMR_HPP
+#define __PTRTOOLS_PMR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include <ptrtools/array.hpp>
+#include <ptrtools/basic.hpp>
+#include <ptrtools/flexible.hpp>
+#include <ptrtools/policy.hpp>
+#include <ptrtools/struct.hpp>
+
+namespace ptrtools
+{
+namespace pmr
+{
+   // Pointer types drawing from a std::pmr::memory_resource. Following the standard containers,
+   // copies go to the default resource and moves between different resources copy the block.
+   using allocator = std::pmr::polymorphic_allocator<std::uint8_t>;
+
+   template <typename T, std::size_t TypeSize=sizeof(T), std::size_t TypeAlign=alignof(T), typename CheckPolicy=default_policy>
+   using basic_ptr = ptrtools::basic_ptr<T,TypeSize,TypeAlign,allocator,CheckPolicy>;
+
+   template <typename T, typename CheckPolicy=default_policy>
+   using array_ptr = ptrtools::array_ptr<T,allocator,CheckPolicy>;
+
+   template <typename T, typename CheckPolicy=default_policy>
+   using struct_ptr = ptrtools::struct_ptr<T,allocator,CheckPolicy>;
+
+   template <typename T, typename FlexibleType, std::size_t StructElements=1, typename CheckPolicy=default_policy>
+   using flexible_ptr = ptrtools::flexible_ptr<T,FlexibleType,StructElements,allocator,CheckPolicy>;
+}
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef __PTRTOOLS_POLICY_HPP
+#define __PTRTOOLS_POLICY_HPP
+
+#include <cassert>
+#include <stdexcept>
+#include <type_traits>
+
+namespace ptrtools
+{
+   // Check policies decide what happens when a null, const, alignment or bounds check fails on the
+   // access path. Allocation errors are always reported with exceptions regardless of the policy.
+   struct checked_policy
+   {
+      static constexpr bool enabled = true;
+
+      static void check(bool condition, const char *message) {
+         if (!condition)
+            throw std::runtime_error(message);
+      }
+   };
+
+   struct debug_policy
+   {
+#ifdef NDEBUG
+      static constexpr bool enabled = false;
+#else
+      static constexpr bool enabled = true;
+#endif
+
+      static void check(bool condition, const char *message) {
+         (void)condition;
+         (void)message;
+         assert(condition && message);
+      }
+   };
+
+   struct unchecked_policy
+   {
+      static constexpr bool enabled = false;
+
+      static void check(bool, const char *) {}
+   };
+
+   using default_policy = checked_policy;
+
+   // Checks like Base and additionally lets pointers share their buffer copy-on-write through
+   // basic_ptr::share(). Sharing has to be chosen in the type because every mutable access then
+   // has to look for other owners, which also keeps the compiler from vectorizing byte loops.
+   template <typename Base=default_policy>
+   struct copy_on_write_policy : Base
+   {
+      static constexpr bool copy_on_write = true;
+   };
+
+   template <typename Policy, typename=void>
+   struct is_copy_on_write : std::false_type {};
+
+   template <typename Policy>
+   struct is_copy_on_write<Policy,std::void_t<decltype(Policy::copy_on_write)>> : std::bool_constant<Policy::copy_on_write> {};
+}
+
+#endif
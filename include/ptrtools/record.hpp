@@ -0,0 +1,229 @@
+#ifndef __PTRTOOLS_RECORD_HPP
+#define __PTRTOOLS_RECORD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <ptrtools/iterator.hpp>
+#include <ptrtools/policy.hpp>
+#include <ptrtools/view.hpp>
+
+namespace ptrtools
+{
+   // Read-only view of one variable-length record: a Header whose last StructElements members
+   // are the first entries of a trailing Entry array, laid out the way flexible_ptr lays them
+   // out. It is two words wide and does no work when copied.
+   template <typename Header, typename Entry, std::size_t StructElements=1, typename CheckPolicy=default_policy>
+   class record_view
+   {
+   public:
+      using header_type = Header;
+      using entry_type = Entry;
+      using check_policy = CheckPolicy;
+      using iterator = basic_iterator<const Entry,sizeof(Entry),CheckPolicy,false>;
+      using entries_view_type = array_view<const Entry,CheckPolicy>;
+      using bytes_view_type = basic_view<const std::uint8_t,1,1,CheckPolicy>;
+
+      const static std::size_t struct_elements = StructElements;
+      const static std::size_t entry_offset = sizeof(Header) - sizeof(Entry) * StructElements;
+
+   private:
+      const std::uint8_t *_ptr = nullptr;
+      std::size_t _size = 0;
+
+   public:
+      record_view() = default;
+      record_view(const std::uint8_t *ptr, std::size_t size) : _ptr(ptr), _size(size) {}
+
+      const Header &operator*() const { return this->header(); }
+      const Header *operator->() const { return &this->header(); }
+      const Entry &operator[](std::size_t index) const {
+         CheckPolicy::check(index < this->elements(), "out of bounds: the given index goes out of bounds of the record");
+
+         return this->entry_data()[index];
+      }
+
+      bool is_null() const { return this->_ptr == nullptr; }
+      const Header &header() const {
+         CheckPolicy::check(this->_ptr != nullptr, "null pointer: attempting to access a null record");
+
+         return *reinterpret_cast<const Header *>(this->_ptr);
+      }
+      const std::uint8_t *data() const { return this->_ptr; }
+      std::size_t size() const { return this->_size; }
+      std::size_t elements() const { return (this->_size - entry_offset) / sizeof(Entry); }
+      const Entry *entry_data() const { return reinterpret_cast<const Entry *>(this->_ptr + entry_offset); }
+
+      iterator begin() const { return iterator(this->entry_data()); }
+      iterator end() const { return iterator(this->entry_data() + this->elements()); }
+
+      entries_view_type entries() const { return entries_view_type(this->entry_data(), this->elements()); }
+      bytes_view_type bytes() const { return bytes_view_type(this->_ptr, this->_size); }
+   };
+
+   // Forward cursor over a buffer of packed variable-length records. length(header) gives the
+   // full size in bytes of the record that starts with header, and every record starts on a
+   // multiple of alignment from the start of the buffer. The alignment is a power of two no
+   // smaller than alignof(Header), and the buffer has to be aligned to it too, so that headers
+   // are read in place. Each record's bounds are validated once, when the cursor reaches it, and
+   // the start of the record after it is prefetched so that it is on its way into cache while
+   // the current one is processed. Malformed input always throws, whatever the check policy,
+   // because it comes from outside the program. A record that ends within sizeof(Header) bytes
+   // of the end of the buffer is rejected too, since its header could not be read whole.
+   //
+   //    auto records = make_record_stream<header, entry>(file.ptr(), [](const header &h) { return h.length; });
+   //    for (auto record : records) ...
+   template <
+      typename Header,
+      typename Entry,
+      typename Length=std::function<std::size_t(const Header &)>,
+      std::size_t StructElements=1,
+      typename CheckPolicy=default_policy>
+   class record_stream
+   {
+   public:
+      using record_type = record_view<Header,Entry,StructElements,CheckPolicy>;
+      using length_type = Length;
+      using check_policy = CheckPolicy;
+
+      const static std::size_t entry_offset = record_type::entry_offset;
+
+   private:
+      const std::uint8_t *_data = nullptr;
+      std::size_t _size = 0;
+      std::size_t _alignment = alignof(Header);
+      Length _length;
+
+   public:
+      class iterator
+      {
+         const record_stream *_stream = nullptr;
+         std::size_t _offset = 0;
+         record_type _record;
+
+         void load() {
+            if (this->_offset < this->_stream->_size)
+            {
+               this->_record = this->_stream->record_at(this->_offset);
+               this->_stream->prefetch(this->_stream->next_offset(this->_offset, this->_record.size()));
+            }
+         }
+
+      public:
+         using iterator_category = std::forward_iterator_tag;
+         using value_type = record_type;
+         using difference_type = std::ptrdiff_t;
+         using pointer = const record_type *;
+         using reference = const record_type &;
+
+         iterator() = default;
+         iterator(const record_stream *stream, std::size_t offset) : _stream(stream), _offset(offset) { this->load(); }
+
+         reference operator*() const { return this->_record; }
+         pointer operator->() const { return &this->_record; }
+         iterator &operator++() {
+            this->_offset = this->_stream->next_offset(this->_offset, this->_record.size());
+            this->load();
+
+            return *this;
+         }
+         iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+         bool operator==(const iterator &other) const { return this->_offset == other._offset; }
+         bool operator!=(const iterator &other) const { return this->_offset != other._offset; }
+
+         std::size_t offset() const { return this->_offset; }
+      };
+
+      record_stream(const std::uint8_t *data, std::size_t size, Length length=Length(), std::size_t alignment=alignof(Header))
+         : _data(data), _size(size), _alignment(alignment), _length(std::move(length))
+      {
+         if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+            throw std::runtime_error("invalid argument: the record alignment must be a power of two");
+
+         if (alignment < alignof(Header) || reinterpret_cast<std::uintptr_t>(data) % alignment != 0)
+            throw std::runtime_error("invalid alignment: records and the buffer must be aligned to at least the header type");
+
+         CheckPolicy::check(data != nullptr || size == 0, "null pointer: attempting to stream records from a null pointer");
+      }
+      // Streams over any byte pointer or view, such as a heap basic_ptr<std::uint8_t> or the
+      // pointer returned by mapped_file::ptr(). The buffer has to outlive the stream.
+      template <typename Buffer, typename = typename std::enable_if<sizeof(typename Buffer::value_type) == 1>::type>
+      record_stream(const Buffer &buffer, Length length=Length(), std::size_t alignment=alignof(Header))
+         : record_stream(reinterpret_cast<const std::uint8_t *>(buffer.get()), buffer.size(), std::move(length), alignment)
+      {}
+
+      iterator begin() const { return iterator(this, 0); }
+      iterator end() const { return iterator(this, this->_size); }
+
+      const std::uint8_t *data() const { return this->_data; }
+      std::size_t size() const { return this->_size; }
+      std::size_t alignment() const { return this->_alignment; }
+
+      // Validates and returns the record starting at offset.
+      record_type record_at(std::size_t offset) const {
+         // the whole Header is read in place, trailing entries included, so it has to fit even
+         // when the record itself ends before them
+         if (offset >= this->_size || this->_size - offset < sizeof(Header))
+            throw std::runtime_error("out of bounds: the record header runs past the end of the stream");
+
+         auto ptr = this->_data + offset;
+         std::size_t length = this->_length(*reinterpret_cast<const Header *>(ptr));
+
+         if (length < entry_offset || length == 0)
+            throw std::runtime_error("invalid record: the record length is shorter than its header");
+
+         if (length > this->_size - offset)
+            throw std::runtime_error("out of bounds: the record length runs past the end of the stream");
+
+         return record_type(ptr, length);
+      }
+      // Offset of the record after the one at offset, or size() when it was the last one.
+      std::size_t next_offset(std::size_t offset, std::size_t length) const {
+         auto next = offset + length;
+
+         next = (next + this->_alignment - 1) & ~(this->_alignment - 1);
+
+         return next < this->_size ? next : this->_size;
+      }
+      // Starts pulling the record at offset into cache.
+      void prefetch(std::size_t offset) const {
+#if defined(__GNUC__) || defined(__clang__)
+         if (offset < this->_size)
+            __builtin_prefetch(this->_data + offset);
+#endif
+      }
+
+      // Calls fn(record) on every record in order and returns how many there were. This is the
+      // same walk as the iterators without the cursor state.
+      template <typename Function>
+      std::size_t for_each(Function fn) const {
+         std::size_t count = 0;
+
+         for (std::size_t offset=0; offset<this->_size; ++count)
+         {
+            auto record = this->record_at(offset);
+
+            offset = this->next_offset(offset, record.size());
+            this->prefetch(offset);
+            fn(record);
+         }
+
+         return count;
+      }
+      std::size_t count() const {
+         return this->for_each([](const record_type &) {});
+      }
+   };
+
+   template <typename Header, typename Entry, std::size_t StructElements=1, typename CheckPolicy=default_policy, typename Buffer, typename Length>
+   record_stream<Header,Entry,Length,StructElements,CheckPolicy> make_record_stream(const Buffer &buffer, Length length, std::size_t alignment=alignof(Header)) {
+      return record_stream<Header,Entry,Length,StructElements,CheckPolicy>(buffer, std::move(length), alignment);
+   }
+}
+
+#endif
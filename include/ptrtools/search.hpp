@@ -0,0 +1,302 @@
+#ifndef __PTRTOOLS_SEARCH_HPP
+#define __PTRTOOLS_SEARCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ptrtools/simd.hpp>
+
+namespace ptrtools
+{
+   struct byte_match
+   {
+      std::size_t offset;
+      std::size_t pattern;
+   };
+
+namespace simd
+{
+   struct scalar_search
+   {
+      static std::size_t find(const std::uint8_t *data, std::size_t size, std::size_t start, const std::uint8_t *pattern, std::size_t pattern_size) {
+         auto last = size - pattern_size;
+
+         while (start <= last)
+         {
+            auto hit = static_cast<const std::uint8_t *>(std::memchr(data + start, pattern[0], last - start + 1));
+
+            if (hit == nullptr)
+               break;
+
+            auto offset = static_cast<std::size_t>(hit - data);
+
+            if (std::memcmp(hit + 1, pattern + 1, pattern_size - 1) == 0)
+               return offset;
+
+            start = offset + 1;
+         }
+
+         return size;
+      }
+   };
+
+#ifdef PTRTOOLS_SIMD_X86
+   // Generic SIMD substring search: a position is a candidate only when both the first and the last
+   // byte of the pattern line up, which rejects almost everything before any memcmp runs.
+   struct sse2_search
+   {
+      PTRTOOLS_TARGET_SSE2 static std::size_t find(const std::uint8_t *data, std::size_t size, std::size_t start, const std::uint8_t *pattern, std::size_t pattern_size) {
+         auto first = _mm_set1_epi8(static_cast<char>(pattern[0]));
+         auto last = _mm_set1_epi8(static_cast<char>(pattern[pattern_size - 1]));
+         auto i = start;
+
+         for (; i + pattern_size - 1 + 16 <= size; i += 16)
+         {
+            auto block_first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            auto block_last = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + pattern_size - 1));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+
+            for (; mask != 0; mask &= mask - 1)
+            {
+               auto offset = i + __builtin_ctz(mask);
+
+               if (std::memcmp(data + offset + 1, pattern + 1, pattern_size - 2) == 0)
+                  return offset;
+            }
+         }
+
+         return scalar_search::find(data, size, i, pattern, pattern_size);
+      }
+   };
+
+   struct avx2_search
+   {
+      PTRTOOLS_TARGET_AVX2 static std::size_t find(const std::uint8_t *data, std::size_t size, std::size_t start, const std::uint8_t *pattern, std::size_t pattern_size) {
+         auto first = _mm256_set1_epi8(static_cast<char>(pattern[0]));
+         auto last = _mm256_set1_epi8(static_cast<char>(pattern[pattern_size - 1]));
+         auto i = start;
+
+         for (; i + pattern_size - 1 + 32 <= size; i += 32)
+         {
+            auto block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            auto block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + pattern_size - 1));
+            auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))));
+
+            for (; mask != 0; mask &= mask - 1)
+            {
+               auto offset = i + __builtin_ctz(mask);
+
+               if (std::memcmp(data + offset + 1, pattern + 1, pattern_size - 2) == 0)
+                  return offset;
+            }
+         }
+
+         return scalar_search::find(data, size, i, pattern, pattern_size);
+      }
+   };
+#endif
+
+   // Offset of the first occurrence of the pattern at or after start, or size when there is none.
+   inline std::size_t find_bytes(const std::uint8_t *data, std::size_t size, std::size_t start, const std::uint8_t *pattern, std::size_t pattern_size) {
+      if (pattern_size == 0)
+         return start <= size ? start : size;
+
+      if (start > size || pattern_size > size - start)
+         return size;
+
+      if (pattern_size == 1)
+      {
+         auto hit = static_cast<const std::uint8_t *>(std::memchr(data + start, pattern[0], size - start));
+
+         return hit == nullptr ? size : static_cast<std::size_t>(hit - data);
+      }
+
+      switch (active_level())
+      {
+#ifdef PTRTOOLS_SIMD_X86
+      case level::avx512:
+      case level::avx2: return avx2_search::find(data, size, start, pattern, pattern_size);
+      case level::sse2: return sse2_search::find(data, size, start, pattern, pattern_size);
+#endif
+      default: return scalar_search::find(data, size, start, pattern, pattern_size);
+      }
+   }
+}
+
+   // A small set of byte patterns compiled for repeated multi-pattern search. With AVX2, candidates
+   // come from a Teddy-style filter: the first few bytes of every position are split into nibbles
+   // and looked up with pshufb in tables holding one bit per pattern bucket, so all patterns are
+   // screened at once. Candidates are confirmed with memcmp. Matches are leftmost first; at equal
+   // offsets the pattern listed first wins.
+   class byte_patterns
+   {
+   public:
+      const static std::size_t buckets = 8;
+      const static std::size_t max_fingerprint = 3;
+
+   private:
+      std::vector<std::string> _patterns;
+      std::vector<std::size_t> _bucket_patterns[buckets];
+      std::size_t _fingerprint = 0;
+      alignas(16) std::uint8_t _low_nibbles[max_fingerprint][16] = {};
+      alignas(16) std::uint8_t _high_nibbles[max_fingerprint][16] = {};
+
+      bool matches_at(const std::uint8_t *data, std::size_t size, std::size_t offset, std::size_t index) const {
+         auto &pattern = this->_patterns[index];
+
+         return pattern.size() <= size - offset && std::memcmp(data + offset, pattern.data(), pattern.size()) == 0;
+      }
+      std::size_t match_bucket_set(const std::uint8_t *data, std::size_t size, std::size_t offset, unsigned bucket_set) const {
+         auto best = this->_patterns.size();
+
+         for (; bucket_set != 0; bucket_set &= bucket_set - 1)
+            for (auto index : this->_bucket_patterns[__builtin_ctz(bucket_set)])
+               if (index < best && this->matches_at(data, size, offset, index))
+                  best = index;
+
+         return best;
+      }
+      // Without pshufb, run the single-pattern search once per pattern. Each pass only has to look
+      // before the best match so far, so later patterns usually scan a shrinking prefix.
+      byte_match find_each(const std::uint8_t *data, std::size_t size, std::size_t start) const {
+         byte_match best{size, this->_patterns.size()};
+
+         for (std::size_t index=0; index<this->_patterns.size() && best.offset > start; ++index)
+         {
+            auto &pattern = this->_patterns[index];
+            auto limit = std::min(size, best.offset - 1 + pattern.size());
+
+            auto offset = simd::find_bytes(data, limit, start, reinterpret_cast<const std::uint8_t *>(pattern.data()), pattern.size());
+
+            if (offset < limit)
+               best = byte_match{offset, index};
+         }
+
+         return best;
+      }
+
+#ifdef PTRTOOLS_SIMD_X86
+      PTRTOOLS_TARGET_AVX2 byte_match find_avx2(const std::uint8_t *data, std::size_t size, std::size_t start) const {
+         __m256i low[max_fingerprint], high[max_fingerprint];
+         auto nibble_mask = _mm256_set1_epi8(0x0F);
+         auto zero = _mm256_setzero_si256();
+         auto i = start;
+
+         for (std::size_t j=0; j<this->_fingerprint; ++j)
+         {
+            low[j] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(this->_low_nibbles[j])));
+            high[j] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(this->_high_nibbles[j])));
+         }
+
+         for (; i + this->_fingerprint - 1 + 32 <= size; i += 32)
+         {
+            auto candidates = _mm256_set1_epi8(static_cast<char>(0xFF));
+
+            for (std::size_t j=0; j<this->_fingerprint; ++j)
+            {
+               auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + j));
+               auto low_bits = _mm256_shuffle_epi8(low[j], _mm256_and_si256(block, nibble_mask));
+               auto high_bits = _mm256_shuffle_epi8(high[j], _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble_mask));
+
+               candidates = _mm256_and_si256(candidates, _mm256_and_si256(low_bits, high_bits));
+            }
+
+            auto mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(candidates, zero)));
+
+            if (mask == 0)
+               continue;
+
+            alignas(32) std::uint8_t bucket_sets[32];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(bucket_sets), candidates);
+
+            for (; mask != 0; mask &= mask - 1)
+            {
+               auto lane = static_cast<std::size_t>(__builtin_ctz(mask));
+               auto index = this->match_bucket_set(data, size, i + lane, bucket_sets[lane]);
+
+               if (index < this->_patterns.size())
+                  return byte_match{i + lane, index};
+            }
+         }
+
+         return this->find_each(data, size, i);
+      }
+#endif
+
+   public:
+      template <typename Container>
+      byte_patterns(const Container &patterns) {
+         for (auto &pattern : patterns)
+            this->add(std::string_view(pattern));
+
+         this->compile();
+      }
+      byte_patterns(std::initializer_list<std::string_view> patterns) {
+         for (auto pattern : patterns)
+            this->add(pattern);
+
+         this->compile();
+      }
+
+   private:
+      void add(std::string_view pattern) {
+         if (pattern.empty())
+            throw std::runtime_error("invalid pattern: search patterns cannot be empty");
+
+         this->_patterns.emplace_back(pattern);
+      }
+      void compile() {
+         if (this->_patterns.empty())
+            throw std::runtime_error("invalid pattern: at least one search pattern is required");
+
+         this->_fingerprint = max_fingerprint;
+
+         for (auto &pattern : this->_patterns)
+            if (pattern.size() < this->_fingerprint)
+               this->_fingerprint = pattern.size();
+
+         for (std::size_t index=0; index<this->_patterns.size(); ++index)
+         {
+            auto &pattern = this->_patterns[index];
+            auto bucket = index % buckets;
+
+            this->_bucket_patterns[bucket].push_back(index);
+
+            for (std::size_t j=0; j<this->_fingerprint; ++j)
+            {
+               auto byte = static_cast<std::uint8_t>(pattern[j]);
+
+               this->_low_nibbles[j][byte & 0x0F] |= static_cast<std::uint8_t>(1 << bucket);
+               this->_high_nibbles[j][byte >> 4] |= static_cast<std::uint8_t>(1 << bucket);
+            }
+         }
+      }
+
+   public:
+      std::size_t size() const { return this->_patterns.size(); }
+      const std::string &pattern(std::size_t index) const { return this->_patterns.at(index); }
+
+      // Leftmost match at or after start. When nothing matches the offset is size and the pattern
+      // index is the number of patterns.
+      byte_match find(const std::uint8_t *data, std::size_t size, std::size_t start=0) const {
+         if (start >= size)
+            return byte_match{size, this->_patterns.size()};
+
+#ifdef PTRTOOLS_SIMD_X86
+         if (static_cast<int>(simd::active_level()) >= static_cast<int>(simd::level::avx2))
+            return this->find_avx2(data, size, start);
+#endif
+
+         return this->find_each(data, size, start);
+      }
+   };
+}
+
+#endif
@@ -0,0 +1,614 @@
+#ifndef __PTRTOOLS_SIMD_HPP
+#define __PTRTOOLS_SIMD_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PTRTOOLS_SIMD_X86
+#define PTRTOOLS_TARGET_SSE2 __attribute__((target("sse2")))
+#define PTRTOOLS_TARGET_AVX2 __attribute__((target("avx2,popcnt,bmi")))
+#define PTRTOOLS_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx2,popcnt,bmi")))
+#endif
+
+namespace ptrtools
+{
+namespace simd
+{
+   // Bulk kernels over contiguous elements. The widest instruction set the CPU supports is picked
+   // at runtime; types without a kernel, and machines without vector units, take the scalar loop.
+   // Kernels compare bit patterns, so they are only used where that matches operator==: integers,
+   // enums and pointers.
+   enum class level
+   {
+      scalar,
+      sse2,
+      avx2,
+      avx512
+   };
+
+   inline level supported_level() {
+#ifdef PTRTOOLS_SIMD_X86
+      static const level detected = []() {
+         __builtin_cpu_init();
+
+         if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return level::avx512;
+         else if (__builtin_cpu_supports("avx2"))
+            return level::avx2;
+         else if (__builtin_cpu_supports("sse2"))
+            return level::sse2;
+
+         return level::scalar;
+      }();
+
+      return detected;
+#else
+      return level::scalar;
+#endif
+   }
+   inline level &selected_level() {
+      static level selected = supported_level();
+      return selected;
+   }
+   inline level active_level() { return selected_level(); }
+
+   // Caps the level used by later calls, e.g. to compare kernels in tests and benchmarks. Levels
+   // beyond what the CPU supports are clamped. Not synchronized with concurrent calls.
+   inline void set_level(level requested) {
+      selected_level() = static_cast<int>(requested) < static_cast<int>(supported_level()) ? requested : supported_level();
+   }
+
+   template <typename T>
+   struct is_bitwise_comparable
+   {
+      const static bool value = std::is_trivially_copyable<T>::value && (std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value);
+   };
+
+   template <std::size_t Width> struct unsigned_of {};
+   template <> struct unsigned_of<1> { using type = std::uint8_t; };
+   template <> struct unsigned_of<2> { using type = std::uint16_t; };
+   template <> struct unsigned_of<4> { using type = std::uint32_t; };
+   template <> struct unsigned_of<8> { using type = std::uint64_t; };
+
+   template <typename T>
+   struct has_lane_width
+   {
+      const static bool value = sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8;
+   };
+
+   struct scalar_kernels
+   {
+      template <typename U>
+      static std::size_t find(const U *data, std::size_t n, U value) {
+         return static_cast<std::size_t>(std::find(data, data + n, value) - data);
+      }
+      template <typename U>
+      static std::size_t count(const U *data, std::size_t n, U value) {
+         return static_cast<std::size_t>(std::count(data, data + n, value));
+      }
+      template <typename U>
+      static void fill(U *data, std::size_t n, U value) {
+         std::fill(data, data + n, value);
+      }
+      static std::size_t mismatch(const std::uint8_t *left, const std::uint8_t *right, std::size_t size) {
+         std::size_t i = 0;
+
+         // compare a word at a time and only walk bytes inside the first differing word
+         for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+         {
+            std::uint64_t left_word, right_word;
+
+            std::memcpy(&left_word, left + i, sizeof(std::uint64_t));
+            std::memcpy(&right_word, right + i, sizeof(std::uint64_t));
+
+            if (left_word != right_word)
+               break;
+         }
+
+         for (; i<size; ++i)
+            if (left[i] != right[i])
+               return i;
+
+         return size;
+      }
+      template <typename U, bool Max>
+      static U reduce(const U *data, std::size_t n) {
+         return Max ? *std::max_element(data, data + n) : *std::min_element(data, data + n);
+      }
+   };
+
+#ifdef PTRTOOLS_SIMD_X86
+   // movemask sets one bit per byte, so SSE2 and AVX2 masks carry sizeof(U) bits per element and
+   // are divided down when turned into indexes; AVX-512 compares produce one bit per element.
+   struct sse2_kernels
+   {
+      const static std::size_t bytes = 16;
+
+      template <typename U>
+      PTRTOOLS_TARGET_SSE2 static __m128i broadcast(U value) {
+         if constexpr (sizeof(U) == 1)
+            return _mm_set1_epi8(static_cast<char>(value));
+         else if constexpr (sizeof(U) == 2)
+            return _mm_set1_epi16(static_cast<short>(value));
+         else if constexpr (sizeof(U) == 4)
+            return _mm_set1_epi32(static_cast<int>(value));
+         else
+            return _mm_set1_epi64x(static_cast<long long>(value));
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_SSE2 static __m128i equal_vector(__m128i left, __m128i right) {
+         if constexpr (sizeof(U) == 1)
+            return _mm_cmpeq_epi8(left, right);
+         else if constexpr (sizeof(U) == 2)
+            return _mm_cmpeq_epi16(left, right);
+         else if constexpr (sizeof(U) == 4)
+            return _mm_cmpeq_epi32(left, right);
+         else
+         {
+            // no 64-bit compare before SSE4.1: both 32-bit halves have to match
+            auto halves = _mm_cmpeq_epi32(left, right);
+
+            return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2,3,0,1)));
+         }
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_SSE2 static unsigned equal_mask(__m128i left, __m128i right) {
+         return static_cast<unsigned>(_mm_movemask_epi8(equal_vector<U>(left, right)));
+      }
+
+      template <typename U>
+      PTRTOOLS_TARGET_SSE2 static std::size_t find(const U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto needle = broadcast(value);
+         std::size_t i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+            if (auto mask = equal_mask<U>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), needle))
+               return i + __builtin_ctz(mask) / sizeof(U);
+
+         return i + scalar_kernels::find(data + i, n - i, value);
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_SSE2 static std::size_t count(const U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto needle = broadcast(value);
+         auto zero = _mm_setzero_si128();
+         auto totals = zero;
+         std::size_t i = 0;
+
+         // SSE2 has no popcnt, so matches are counted per byte lane and folded with psadbw before
+         // any byte counter can wrap
+         while (i + lanes <= n)
+         {
+            auto counters = zero;
+
+            for (std::size_t step=0; step<255 && i + lanes <= n; ++step, i += lanes)
+               counters = _mm_sub_epi8(counters, equal_vector<U>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), needle));
+
+            totals = _mm_add_epi64(totals, _mm_sad_epu8(counters, zero));
+         }
+
+         std::uint64_t halves[2];
+         _mm_storeu_si128(reinterpret_cast<__m128i *>(halves), totals);
+
+         return static_cast<std::size_t>(halves[0] + halves[1]) / sizeof(U) + scalar_kernels::count(data + i, n - i, value);
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_SSE2 static void fill(U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto pattern = broadcast(value);
+         std::size_t i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), pattern);
+
+         scalar_kernels::fill(data + i, n - i, value);
+      }
+      PTRTOOLS_TARGET_SSE2 static std::size_t mismatch(const std::uint8_t *left, const std::uint8_t *right, std::size_t size) {
+         std::size_t i = 0;
+
+         for (; i + bytes <= size; i += bytes)
+         {
+            auto mask = equal_mask<std::uint8_t>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(left + i)),
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(right + i)));
+
+            if (mask != 0xFFFF)
+               return i + __builtin_ctz(~mask);
+         }
+
+         return i + scalar_kernels::mismatch(left + i, right + i, size - i);
+      }
+   };
+
+   struct avx2_kernels
+   {
+      const static std::size_t bytes = 32;
+
+      template <typename U>
+      PTRTOOLS_TARGET_AVX2 static __m256i broadcast(U value) {
+         if constexpr (sizeof(U) == 1)
+            return _mm256_set1_epi8(static_cast<char>(value));
+         else if constexpr (sizeof(U) == 2)
+            return _mm256_set1_epi16(static_cast<short>(value));
+         else if constexpr (sizeof(U) == 4)
+            return _mm256_set1_epi32(static_cast<int>(value));
+         else
+            return _mm256_set1_epi64x(static_cast<long long>(value));
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_AVX2 static unsigned equal_mask(__m256i left, __m256i right) {
+         if constexpr (sizeof(U) == 1)
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(left, right)));
+         else if constexpr (sizeof(U) == 2)
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(left, right)));
+         else if constexpr (sizeof(U) == 4)
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(left, right)));
+         else
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(left, right)));
+      }
+      template <typename U, bool Max>
+      PTRTOOLS_TARGET_AVX2 static __m256i select(__m256i left, __m256i right) {
+         const bool is_signed = std::is_signed<U>::value;
+
+         if constexpr (sizeof(U) == 1)
+            return Max ? (is_signed ? _mm256_max_epi8(left, right) : _mm256_max_epu8(left, right))
+                       : (is_signed ? _mm256_min_epi8(left, right) : _mm256_min_epu8(left, right));
+         else if constexpr (sizeof(U) == 2)
+            return Max ? (is_signed ? _mm256_max_epi16(left, right) : _mm256_max_epu16(left, right))
+                       : (is_signed ? _mm256_min_epi16(left, right) : _mm256_min_epu16(left, right));
+         else if constexpr (sizeof(U) == 4)
+            return Max ? (is_signed ? _mm256_max_epi32(left, right) : _mm256_max_epu32(left, right))
+                       : (is_signed ? _mm256_min_epi32(left, right) : _mm256_min_epu32(left, right));
+         else
+            return left;
+      }
+
+      template <typename U>
+      PTRTOOLS_TARGET_AVX2 static std::size_t find(const U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto needle = broadcast(value);
+         std::size_t i = 0;
+
+         // test two vectors per step so the branch is taken half as often on long misses
+         for (; i + 2 * lanes <= n; i += 2 * lanes)
+         {
+            auto first = equal_mask<U>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), needle);
+            auto second = equal_mask<U>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + lanes)), needle);
+
+            if (first | second)
+               return first ? i + __builtin_ctz(first) / sizeof(U) : i + lanes + __builtin_ctz(second) / sizeof(U);
+         }
+
+         for (; i + lanes <= n; i += lanes)
+            if (auto mask = equal_mask<U>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), needle))
+               return i + __builtin_ctz(mask) / sizeof(U);
+
+         return i + scalar_kernels::find(data + i, n - i, value);
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_AVX2 static std::size_t count(const U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto needle = broadcast(value);
+         std::size_t result = 0, i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+            result += __builtin_popcount(equal_mask<U>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), needle));
+
+         return result / sizeof(U) + scalar_kernels::count(data + i, n - i, value);
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_AVX2 static void fill(U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto pattern = broadcast(value);
+         std::size_t i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i), pattern);
+
+         scalar_kernels::fill(data + i, n - i, value);
+      }
+      PTRTOOLS_TARGET_AVX2 static std::size_t mismatch(const std::uint8_t *left, const std::uint8_t *right, std::size_t size) {
+         std::size_t i = 0;
+
+         for (; i + bytes <= size; i += bytes)
+         {
+            auto mask = equal_mask<std::uint8_t>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + i)),
+                                                 _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + i)));
+
+            if (mask != 0xFFFFFFFFu)
+               return i + __builtin_ctz(~mask);
+         }
+
+         return i + scalar_kernels::mismatch(left + i, right + i, size - i);
+      }
+      template <typename U, bool Max>
+      PTRTOOLS_TARGET_AVX2 static U reduce(const U *data, std::size_t n) {
+         const std::size_t lanes = bytes / sizeof(U);
+
+         // AVX2 has no 64-bit minimum or maximum
+         if (sizeof(U) == 8 || n < lanes)
+            return scalar_kernels::reduce<U,Max>(data, n);
+
+         auto accumulator = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+         std::size_t i = lanes;
+
+         for (; i + lanes <= n; i += lanes)
+            accumulator = select<U,Max>(accumulator, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+
+         U lanes_out[bytes / sizeof(U)];
+         _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes_out), accumulator);
+
+         auto result = scalar_kernels::reduce<U,Max>(lanes_out, lanes);
+
+         if (i < n)
+         {
+            auto tail = scalar_kernels::reduce<U,Max>(data + i, n - i);
+
+            if (Max ? result < tail : tail < result)
+               result = tail;
+         }
+
+         return result;
+      }
+   };
+
+   struct avx512_kernels
+   {
+      const static std::size_t bytes = 64;
+
+      template <typename U>
+      PTRTOOLS_TARGET_AVX512 static __m512i broadcast(U value) {
+         if constexpr (sizeof(U) == 1)
+            return _mm512_set1_epi8(static_cast<char>(value));
+         else if constexpr (sizeof(U) == 2)
+            return _mm512_set1_epi16(static_cast<short>(value));
+         else if constexpr (sizeof(U) == 4)
+            return _mm512_set1_epi32(static_cast<int>(value));
+         else
+            return _mm512_set1_epi64(static_cast<long long>(value));
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_AVX512 static std::uint64_t equal_mask(__m512i left, __m512i right) {
+         if constexpr (sizeof(U) == 1)
+            return _mm512_cmpeq_epi8_mask(left, right);
+         else if constexpr (sizeof(U) == 2)
+            return _mm512_cmpeq_epi16_mask(left, right);
+         else if constexpr (sizeof(U) == 4)
+            return _mm512_cmpeq_epi32_mask(left, right);
+         else
+            return _mm512_cmpeq_epi64_mask(left, right);
+      }
+      template <typename U, bool Max>
+      PTRTOOLS_TARGET_AVX512 static __m512i select(__m512i left, __m512i right) {
+         const bool is_signed = std::is_signed<U>::value;
+
+         if constexpr (sizeof(U) == 1)
+            return Max ? (is_signed ? _mm512_max_epi8(left, right) : _mm512_max_epu8(left, right))
+                       : (is_signed ? _mm512_min_epi8(left, right) : _mm512_min_epu8(left, right));
+         else if constexpr (sizeof(U) == 2)
+            return Max ? (is_signed ? _mm512_max_epi16(left, right) : _mm512_max_epu16(left, right))
+                       : (is_signed ? _mm512_min_epi16(left, right) : _mm512_min_epu16(left, right));
+         else if constexpr (sizeof(U) == 4)
+            return Max ? (is_signed ? _mm512_max_epi32(left, right) : _mm512_max_epu32(left, right))
+                       : (is_signed ? _mm512_min_epi32(left, right) : _mm512_min_epu32(left, right));
+         else
+            return Max ? (is_signed ? _mm512_max_epi64(left, right) : _mm512_max_epu64(left, right))
+                       : (is_signed ? _mm512_min_epi64(left, right) : _mm512_min_epu64(left, right));
+      }
+
+      template <typename U>
+      PTRTOOLS_TARGET_AVX512 static std::size_t find(const U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto needle = broadcast(value);
+         std::size_t i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+            if (auto mask = equal_mask<U>(_mm512_loadu_si512(data + i), needle))
+               return i + __builtin_ctzll(mask);
+
+         return i + scalar_kernels::find(data + i, n - i, value);
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_AVX512 static std::size_t count(const U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto needle = broadcast(value);
+         std::size_t result = 0, i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+            result += __builtin_popcountll(equal_mask<U>(_mm512_loadu_si512(data + i), needle));
+
+         return result + scalar_kernels::count(data + i, n - i, value);
+      }
+      template <typename U>
+      PTRTOOLS_TARGET_AVX512 static void fill(U *data, std::size_t n, U value) {
+         const std::size_t lanes = bytes / sizeof(U);
+         auto pattern = broadcast(value);
+         std::size_t i = 0;
+
+         for (; i + lanes <= n; i += lanes)
+            _mm512_storeu_si512(data + i, pattern);
+
+         scalar_kernels::fill(data + i, n - i, value);
+      }
+      PTRTOOLS_TARGET_AVX512 static std::size_t mismatch(const std::uint8_t *left, const std::uint8_t *right, std::size_t size) {
+         std::size_t i = 0;
+
+         for (; i + bytes <= size; i += bytes)
+         {
+            auto mask = _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(left + i), _mm512_loadu_si512(right + i));
+
+            if (mask != 0)
+               return i + __builtin_ctzll(mask);
+         }
+
+         return i + scalar_kernels::mismatch(left + i, right + i, size - i);
+      }
+      template <typename U, bool Max>
+      PTRTOOLS_TARGET_AVX512 static U reduce(const U *data, std::size_t n) {
+         const std::size_t lanes = bytes / sizeof(U);
+
+         if (n < lanes)
+            return scalar_kernels::reduce<U,Max>(data, n);
+
+         auto accumulator = _mm512_loadu_si512(data);
+         std::size_t i = lanes;
+
+         for (; i + lanes <= n; i += lanes)
+            accumulator = select<U,Max>(accumulator, _mm512_loadu_si512(data + i));
+
+         U lanes_out[bytes / sizeof(U)];
+         _mm512_storeu_si512(lanes_out, accumulator);
+
+         auto result = scalar_kernels::reduce<U,Max>(lanes_out, lanes);
+
+         if (i < n)
+         {
+            auto tail = scalar_kernels::reduce<U,Max>(data + i, n - i);
+
+            if (Max ? result < tail : tail < result)
+               result = tail;
+         }
+
+         return result;
+      }
+   };
+#endif
+
+   template <typename T>
+   typename unsigned_of<sizeof(T)>::type bits_of(const T &value) {
+      typename unsigned_of<sizeof(T)>::type result;
+      std::memcpy(&result, &value, sizeof(T));
+      return result;
+   }
+
+   template <typename T>
+   std::size_t find(const T *data, std::size_t n, const T &value) {
+      if constexpr (is_bitwise_comparable<T>::value && has_lane_width<T>::value)
+      {
+         using bits = typename unsigned_of<sizeof(T)>::type;
+         auto words = reinterpret_cast<const bits *>(data);
+
+         switch (active_level())
+         {
+#ifdef PTRTOOLS_SIMD_X86
+         case level::avx512: return avx512_kernels::find(words, n, bits_of(value));
+         case level::avx2: return avx2_kernels::find(words, n, bits_of(value));
+         case level::sse2: return sse2_kernels::find(words, n, bits_of(value));
+#endif
+         default: return scalar_kernels::find(words, n, bits_of(value));
+         }
+      }
+      else
+         return scalar_kernels::find(data, n, value);
+   }
+   template <typename T>
+   std::size_t count(const T *data, std::size_t n, const T &value) {
+      if constexpr (is_bitwise_comparable<T>::value && has_lane_width<T>::value)
+      {
+         using bits = typename unsigned_of<sizeof(T)>::type;
+         auto words = reinterpret_cast<const bits *>(data);
+
+         switch (active_level())
+         {
+#ifdef PTRTOOLS_SIMD_X86
+         case level::avx512: return avx512_kernels::count(words, n, bits_of(value));
+         case level::avx2: return avx2_kernels::count(words, n, bits_of(value));
+         case level::sse2: return sse2_kernels::count(words, n, bits_of(value));
+#endif
+         default: return scalar_kernels::count(words, n, bits_of(value));
+         }
+      }
+      else
+         return scalar_kernels::count(data, n, value);
+   }
+   template <typename T>
+   bool contains(const T *data, std::size_t n, const T &value) { return find(data, n, value) != n; }
+
+   template <typename T>
+   void fill(T *data, std::size_t n, const T &value) {
+      if (n == 0)
+         return;
+
+      if constexpr (std::is_trivially_copyable<T>::value && sizeof(T) == 1)
+         std::memset(data, bits_of(value), n);
+      else if constexpr (std::is_trivially_copyable<T>::value && has_lane_width<T>::value)
+      {
+         using bits = typename unsigned_of<sizeof(T)>::type;
+         auto words = reinterpret_cast<bits *>(data);
+
+         switch (active_level())
+         {
+#ifdef PTRTOOLS_SIMD_X86
+         case level::avx512: avx512_kernels::fill(words, n, bits_of(value)); break;
+         case level::avx2: avx2_kernels::fill(words, n, bits_of(value)); break;
+         case level::sse2: sse2_kernels::fill(words, n, bits_of(value)); break;
+#endif
+         default: scalar_kernels::fill(words, n, bits_of(value)); break;
+         }
+      }
+      else
+         scalar_kernels::fill(data, n, value);
+   }
+
+   // Index of the first element that differs between the two ranges, or n when they are equal.
+   template <typename T>
+   std::size_t mismatch(const T *left, const T *right, std::size_t n) {
+      if constexpr (is_bitwise_comparable<T>::value)
+      {
+         auto left_bytes = reinterpret_cast<const std::uint8_t *>(left);
+         auto right_bytes = reinterpret_cast<const std::uint8_t *>(right);
+         std::size_t result;
+
+         switch (active_level())
+         {
+#ifdef PTRTOOLS_SIMD_X86
+         case level::avx512: result = avx512_kernels::mismatch(left_bytes, right_bytes, n * sizeof(T)); break;
+         case level::avx2: result = avx2_kernels::mismatch(left_bytes, right_bytes, n * sizeof(T)); break;
+         case level::sse2: result = sse2_kernels::mismatch(left_bytes, right_bytes, n * sizeof(T)); break;
+#endif
+         default: result = scalar_kernels::mismatch(left_bytes, right_bytes, n * sizeof(T)); break;
+         }
+
+         return result / sizeof(T);
+      }
+      else
+      {
+         for (std::size_t i=0; i<n; ++i)
+            if (!(left[i] == right[i]))
+               return i;
+
+         return n;
+      }
+   }
+   template <typename T>
+   bool equal(const T *left, const T *right, std::size_t n) { return mismatch(left, right, n) == n; }
+
+   template <typename T, bool Max>
+   T reduce(const T *data, std::size_t n) {
+      if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value && has_lane_width<T>::value)
+      {
+         switch (active_level())
+         {
+#ifdef PTRTOOLS_SIMD_X86
+         case level::avx512: return avx512_kernels::reduce<T,Max>(data, n);
+         case level::avx2: return avx2_kernels::reduce<T,Max>(data, n);
+#endif
+         default: return scalar_kernels::reduce<T,Max>(data, n);
+         }
+      }
+      else
+         return scalar_kernels::reduce<T,Max>(data, n);
+   }
+   template <typename T>
+   T min(const T *data, std::size_t n) { return reduce<T,false>(data, n); }
+   template <typename T>
+   T max(const T *data, std::size_t n) { return reduce<T,true>(data, n); }
+}
+}
+
+#endif
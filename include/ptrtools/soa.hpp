@@ -0,0 +1,268 @@
+#ifndef __PTRTOOLS_SOA_HPP
+#define __PTRTOOLS_SOA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <ptrtools/array.hpp>
+#include <ptrtools/memory.hpp>
+#include <ptrtools/parallel.hpp>
+#include <ptrtools/policy.hpp>
+#include <ptrtools/view.hpp>
+
+namespace ptrtools
+{
+   template <typename Member>
+   struct member_traits {};
+
+   template <typename Field, typename Class>
+   struct member_traits<Field Class::*>
+   {
+      using field_type = Field;
+      using class_type = Class;
+   };
+
+   // Structure-of-arrays storage for T: every listed member of T lives in its own array_ptr
+   // column, all built from copies of the same allocator, so a scan over one member reads only
+   // that member. Elements are reached through proxies that load and store whole T values or a
+   // single member, and members of T that are not listed are not stored.
+   //
+   //    soa_array<record, &record::id, &record::price> table(records);
+   //    auto highest = simd::max(table.column<&record::price>().get(), table.elements());
+   template <typename T, typename Allocator, typename CheckPolicy, auto... Fields>
+   class basic_soa_array
+   {
+      static_assert(sizeof...(Fields) > 0, "A structure of arrays needs at least one field");
+      static_assert((std::is_base_of<typename member_traits<decltype(Fields)>::class_type,T>::value && ...), "Every field must be a member of T");
+
+   public:
+      using value_type = T;
+      using allocator = Allocator;
+      using check_policy = CheckPolicy;
+
+      template <auto Field>
+      using field_type = typename member_traits<decltype(Field)>::field_type;
+
+      template <auto Field>
+      using column_ptr = array_ptr<field_type<Field>,Allocator,CheckPolicy>;
+
+      template <auto Field>
+      using column_view = array_view<field_type<Field>,CheckPolicy>;
+
+      template <auto Field>
+      using const_column_view = array_view<const field_type<Field>,CheckPolicy>;
+
+      const static std::size_t fields = sizeof...(Fields);
+
+   private:
+      std::tuple<column_ptr<Fields>...> _columns;
+      std::size_t _elements = 0;
+
+      template <auto Left, auto Right>
+      static constexpr bool same_field() {
+         if constexpr (std::is_same<decltype(Left),decltype(Right)>::value)
+            return Left == Right;
+         else
+            return false;
+      }
+      template <auto Field>
+      static constexpr std::size_t index_of() {
+         constexpr bool matches[] = { same_field<Field,Fields>()... };
+
+         for (std::size_t index=0; index<sizeof...(Fields); ++index)
+            if (matches[index])
+               return index;
+
+         return sizeof...(Fields);
+      }
+      template <auto Field>
+      column_ptr<Field> &column_of() {
+         static_assert(index_of<Field>() < sizeof...(Fields), "The field is not stored in this structure of arrays");
+
+         return std::get<index_of<Field>()>(this->_columns);
+      }
+      template <auto Field>
+      const column_ptr<Field> &column_of() const {
+         static_assert(index_of<Field>() < sizeof...(Fields), "The field is not stored in this structure of arrays");
+
+         return std::get<index_of<Field>()>(this->_columns);
+      }
+
+      std::size_t checked_index(std::size_t index) const {
+         CheckPolicy::check(index < this->_elements, "out of bounds: the given index goes out of bounds of the structure of arrays");
+
+         return index;
+      }
+
+   public:
+      // Stands in for one element. get<Field>() references the stored member; conversion to T,
+      // operator-> and load() gather a T from the columns and assignment scatters one into them.
+      template <bool Const>
+      class element_proxy
+      {
+         using owner_type = typename std::conditional<Const, const basic_soa_array, basic_soa_array>::type;
+
+         owner_type *_owner;
+         std::size_t _index;
+
+      public:
+         struct arrow
+         {
+            T value;
+
+            const T *operator->() const { return &this->value; }
+         };
+
+         element_proxy(owner_type *owner, std::size_t index) : _owner(owner), _index(index) {}
+         element_proxy(const element_proxy &other) = default;
+
+         element_proxy &operator=(const T &value) { this->store(value); return *this; }
+         element_proxy &operator=(const element_proxy &other) { this->store(other.load()); return *this; }
+         operator T() const { return this->load(); }
+         arrow operator->() const { return arrow{this->load()}; }
+
+         template <auto Field>
+         typename std::conditional<Const, const field_type<Field> &, field_type<Field> &>::type get() const {
+            return this->_owner->template column_of<Field>().get()[this->_index];
+         }
+         T load() const {
+            T result{};
+
+            ((result.*Fields = this->template get<Fields>()), ...);
+
+            return result;
+         }
+         void store(const T &value) const {
+            static_assert(!Const, "Cannot store through a const element");
+
+            ((this->template get<Fields>() = value.*Fields), ...);
+         }
+         std::size_t index() const { return this->_index; }
+      };
+
+      using reference = element_proxy<false>;
+      using const_reference = element_proxy<true>;
+
+      basic_soa_array() {}
+      basic_soa_array(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
+         if (elements > 0)
+            this->allocate(elements, mode);
+      }
+      basic_soa_array(const Allocator &allocator) : _columns(column_ptr<Fields>(allocator)...) {}
+      basic_soa_array(std::size_t elements, const Allocator &allocator, allocation_mode mode=allocation_mode::zeroed) : _columns(column_ptr<Fields>(allocator)...) {
+         if (elements > 0)
+            this->allocate(elements, mode);
+      }
+      template <typename OtherAllocator, typename OtherPolicy>
+      explicit basic_soa_array(const array_ptr<T,OtherAllocator,OtherPolicy> &records, std::size_t grain=0) { this->assign(records, grain); }
+
+      reference operator[](std::size_t index) { return reference(this, this->checked_index(index)); }
+      const_reference operator[](std::size_t index) const { return const_reference(this, this->checked_index(index)); }
+
+      reference at(std::size_t index) { return (*this)[index]; }
+      const_reference at(std::size_t index) const { return (*this)[index]; }
+      reference front() { return (*this)[0]; }
+      const_reference front() const { return (*this)[0]; }
+      reference back() { return (*this)[this->_elements-1]; }
+      const_reference back() const { return (*this)[this->_elements-1]; }
+
+      std::size_t elements() const { return this->_elements; }
+      bool empty() const { return this->_elements == 0; }
+      Allocator get_allocator() const { return std::get<0>(this->_columns).get_allocator(); }
+
+      template <auto Field>
+      column_view<Field> column() { return this->template column_of<Field>().view(); }
+      template <auto Field>
+      const_column_view<Field> column() const { return this->template column_of<Field>().view(); }
+
+      void allocate(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
+         (this->template column_of<Fields>().allocate(elements, mode), ...);
+         this->_elements = elements;
+      }
+      void reallocate(std::size_t elements, allocation_mode mode=allocation_mode::zeroed) {
+         (this->template column_of<Fields>().reallocate(elements, mode), ...);
+         this->_elements = elements;
+      }
+      void reserve(std::size_t elements) {
+         (this->template column_of<Fields>().reserve(elements), ...);
+      }
+      void clear() {
+         ((this->template column_of<Fields>().is_allocated() ? this->template column_of<Fields>().deallocate() : void()), ...);
+         this->_elements = 0;
+      }
+      void push_back(const T &value) {
+         (this->template column_of<Fields>().push_back(value.*Fields), ...);
+         ++this->_elements;
+      }
+
+      // AoS to SoA: replaces the contents with the listed members of every record. Each chunk of
+      // records is written one column at a time so every column is filled sequentially, and the
+      // chunks run in parallel on the shared thread pool.
+      template <typename Records>
+      void assign(const Records &records, std::size_t grain=0) {
+         auto elements = records.elements();
+         auto source = records.get();
+
+         if (elements == 0)
+         {
+            this->clear();
+            return;
+         }
+
+         this->allocate(elements, allocation_mode::uninitialized);
+
+         auto columns = std::make_tuple(this->template column_of<Fields>().get()...);
+         auto chunk = grain == 0 ? std::max<std::size_t>(parallel::default_grain_bytes / sizeof(T), 1) : grain;
+
+         parallel::for_chunks(thread_pool::global(), elements, chunk, [source, &columns](std::size_t begin, std::size_t end) {
+            std::apply([source, begin, end](auto... column) {
+               ((transpose_from<Fields>(column, source, begin, end)), ...);
+            }, columns);
+         });
+      }
+      // SoA to AoS: writes the listed members of every element into records, which must hold
+      // at least elements() records. Members that are not stored are left untouched.
+      template <typename Records>
+      void gather_to(Records &records, std::size_t grain=0) const {
+         CheckPolicy::check(records.elements() >= this->_elements, "out of bounds: the destination holds fewer records than the structure of arrays");
+
+         auto destination = records.get();
+         auto columns = std::make_tuple(this->template column_of<Fields>().get()...);
+         auto chunk = grain == 0 ? std::max<std::size_t>(parallel::default_grain_bytes / sizeof(T), 1) : grain;
+
+         parallel::for_chunks(thread_pool::global(), this->_elements, chunk, [destination, &columns](std::size_t begin, std::size_t end) {
+            std::apply([destination, begin, end](auto... column) {
+               ((transpose_to<Fields>(column, destination, begin, end)), ...);
+            }, columns);
+         });
+      }
+      array_ptr<T,Allocator,CheckPolicy> to_array(std::size_t grain=0) const {
+         array_ptr<T,Allocator,CheckPolicy> result(this->_elements, this->get_allocator());
+
+         this->gather_to(result, grain);
+
+         return result;
+      }
+
+   private:
+      template <auto Field, typename Column, typename Source>
+      static void transpose_from(Column column, Source source, std::size_t begin, std::size_t end) {
+         for (auto i=begin; i<end; ++i)
+            column[i] = source[i].*Field;
+      }
+      template <auto Field, typename Column, typename Destination>
+      static void transpose_to(Column column, Destination destination, std::size_t begin, std::size_t end) {
+         for (auto i=begin; i<end; ++i)
+            destination[i].*Field = column[i];
+      }
+   };
+
+   template <typename T, auto... Fields>
+   using soa_array = basic_soa_array<T,std::allocator<std::uint8_t>,default_policy,Fields...>;
+}
+
+#endif
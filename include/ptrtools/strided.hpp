@@ -0,0 +1,163 @@
+#ifndef __PTRTOOLS_STRIDED_HPP
+#define __PTRTOOLS_STRIDED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <ptrtools/iterator.hpp>
+#include <ptrtools/policy.hpp>
+
+namespace ptrtools
+{
+   // Non-owning view of one field of every element in an array of structs: elements() fields,
+   // stride() bytes apart, starting at get(). It lets a loop touch a single column of an
+   // array_ptr<Record> without copying it out. Like the other views, constness is part of Field.
+   template <typename Field, typename CheckPolicy=default_policy>
+   class strided_view
+   {
+      static_assert(!std::is_void<Field>::value, "Field cannot be void");
+
+   public:
+      using value_type = Field;
+      using pointer = value_type *;
+      using const_pointer = const value_type *;
+      using reference = value_type &;
+      using const_reference = const value_type &;
+      using check_policy = CheckPolicy;
+      using iterator = strided_iterator<Field,CheckPolicy>;
+      using const_iterator = strided_iterator<const Field,CheckPolicy>;
+
+   private:
+      pointer _ptr = nullptr;
+      std::size_t _stride = sizeof(Field);
+      std::size_t _elements = 0;
+
+      pointer address_of(std::size_t index) const {
+         return reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(this->_ptr) + index * this->_stride);
+      }
+
+   public:
+      strided_view() = default;
+      strided_view(pointer ptr, std::size_t stride, std::size_t elements) : _ptr(ptr), _stride(stride), _elements(elements) {
+         CheckPolicy::check(stride >= sizeof(Field), "invalid argument: the stride is smaller than the field");
+         CheckPolicy::check(ptr != nullptr || elements == 0, "null pointer: attempting to view fields of a null pointer");
+      }
+      template <typename U, typename = typename std::enable_if<std::is_same<const U, Field>::value && !std::is_const<U>::value>::type>
+      strided_view(const strided_view<U,CheckPolicy> &other) : _ptr(other.get()), _stride(other.stride()), _elements(other.elements()) {}
+
+      reference operator[](std::size_t index) const { return this->at(index); }
+
+      bool is_const() const { return std::is_const<Field>::value; }
+      bool is_null() const { return this->_ptr == nullptr; }
+      bool empty() const { return this->_elements == 0; }
+
+      pointer get() const { return this->_ptr; }
+      std::size_t stride() const { return this->_stride; }
+      std::size_t elements() const { return this->_elements; }
+      reference front() const { return (*this)[0]; }
+      reference back() const { return (*this)[this->_elements-1]; }
+
+      iterator begin() const { return iterator(this->_ptr, this->_stride); }
+      const_iterator cbegin() const { return const_iterator(this->_ptr, this->_stride); }
+      iterator end() const { return iterator(this->address_of(this->_elements), this->_stride); }
+      const_iterator cend() const { return const_iterator(this->address_of(this->_elements), this->_stride); }
+
+      reference at(std::size_t index) const {
+         CheckPolicy::check(this->_ptr != nullptr, "null pointer: attempting to access a null pointer");
+         CheckPolicy::check(index < this->_elements, "out of bounds: the given index goes out of bounds of the strided view");
+
+         return *this->address_of(index);
+      }
+      strided_view<Field,CheckPolicy> slice(std::size_t index, std::size_t elements) const {
+         CheckPolicy::check(index <= this->_elements && elements <= this->_elements - index, "out of bounds: the slice exceeds the strided view");
+
+         return strided_view<Field,CheckPolicy>(elements == 0 ? this->_ptr : this->address_of(index), this->_stride, elements);
+      }
+
+      // Copies the fields into the contiguous array out, which must hold at least elements().
+      template <typename Out>
+      void gather_to(Out &out) const {
+         CheckPolicy::check(out.elements() >= this->_elements, "out of bounds: the gather destination is smaller than the strided view");
+
+         auto destination = out.get();
+
+         for (std::size_t i=0; i<this->_elements; ++i)
+            destination[i] = *this->address_of(i);
+      }
+      // Overwrites the fields with the first elements() values of the contiguous array in.
+      template <typename In>
+      void scatter_from(const In &in) const {
+         CheckPolicy::check(in.elements() >= this->_elements, "out of bounds: the scatter source is smaller than the strided view");
+
+         auto source = in.get();
+
+         for (std::size_t i=0; i<this->_elements; ++i)
+            *this->address_of(i) = source[i];
+      }
+      void fill(const_reference value) const {
+         for (std::size_t i=0; i<this->_elements; ++i)
+            *this->address_of(i) = value;
+      }
+
+      template <typename T, typename Operation>
+      T reduce(T init, Operation op) const {
+         for (std::size_t i=0; i<this->_elements; ++i)
+            init = op(init, *this->address_of(i));
+
+         return init;
+      }
+      // Four independent accumulators keep the adds from serializing on one register, which
+      // matters because every field sits on a different cache line.
+      template <typename T=typename std::remove_cv<Field>::type>
+      T sum() const {
+         T partial[4] = { T(), T(), T(), T() };
+         std::size_t i = 0;
+
+         for (; i + 4 <= this->_elements; i += 4)
+         {
+            partial[0] += *this->address_of(i);
+            partial[1] += *this->address_of(i+1);
+            partial[2] += *this->address_of(i+2);
+            partial[3] += *this->address_of(i+3);
+         }
+
+         for (; i<this->_elements; ++i)
+            partial[0] += *this->address_of(i);
+
+         return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+      }
+      std::size_t count(const_reference value) const {
+         std::size_t result = 0;
+
+         for (std::size_t i=0; i<this->_elements; ++i)
+            result += *this->address_of(i) == value;
+
+         return result;
+      }
+      typename std::remove_cv<Field>::type min() const {
+         CheckPolicy::check(this->_elements > 0, "out of bounds: cannot take the minimum of an empty view");
+
+         auto result = *this->_ptr;
+
+         for (std::size_t i=1; i<this->_elements; ++i)
+            if (*this->address_of(i) < result)
+               result = *this->address_of(i);
+
+         return result;
+      }
+      typename std::remove_cv<Field>::type max() const {
+         CheckPolicy::check(this->_elements > 0, "out of bounds: cannot take the maximum of an empty view");
+
+         auto result = *this->_ptr;
+
+         for (std::size_t i=1; i<this->_elements; ++i)
+            if (result < *this->address_of(i))
+               result = *this->address_of(i);
+
+         return result;
+      }
+   };
+}
+
+#endif
@@ -5,17 +5,20 @@
 
 namespace ptrtools
 {
-   template <typename T, typename Allocator=std::allocator<std::uint8_t>>
-   class struct_ptr : public basic_ptr<T,sizeof(T),alignof(T),Allocator>
+   template <typename T, typename Allocator=std::allocator<std::uint8_t>, typename CheckPolicy=default_policy>
+   class struct_ptr : public basic_ptr<T,sizeof(T),alignof(T),Allocator,CheckPolicy>
    {
    public:
-      using basic_ptr_decl = basic_ptr<T,sizeof(T),alignof(T),Allocator>;
+      using basic_ptr_decl = basic_ptr<T,sizeof(T),alignof(T),Allocator,CheckPolicy>;
       using value_type = typename basic_ptr_decl::value_type;
       using pointer = typename basic_ptr_decl::pointer;
       using const_pointer = typename basic_ptr_decl::const_pointer;
       using reference = typename basic_ptr_decl::reference;
       using const_reference = typename basic_ptr_decl::const_reference;
       using allocator = Allocator;
+      using check_policy = CheckPolicy;
+      using view_type = struct_view<T,CheckPolicy>;
+      using const_view_type = struct_view<const T,CheckPolicy>;
 
    private:
       using typename basic_ptr_decl::iterator;
@@ -25,7 +28,12 @@ namespace ptrtools
 
    public:
       struct_ptr(bool allocate=false) : basic_ptr_decl(allocate) {}
-      struct_ptr(std::size_t size) : basic_ptr_decl(size) {}
+      struct_ptr(std::size_t size, allocation_mode mode=allocation_mode::zeroed) : basic_ptr_decl(size, mode) {}
+      struct_ptr(const Allocator &allocator, bool allocate=false) : basic_ptr_decl(allocator) {
+         if (allocate)
+            this->allocate(this->type_size);
+      }
+      struct_ptr(std::size_t size, const Allocator &allocator, allocation_mode mode=allocation_mode::zeroed) : basic_ptr_decl(size, allocator, mode) {}
       struct_ptr(pointer ptr, std::size_t size=basic_ptr_decl::type_size, bool clone=false)
          : basic_ptr_decl(ptr, size, clone)
       {}
@@ -34,22 +42,22 @@ namespace ptrtools
       {}
       struct_ptr(basic_ptr_decl &ptr) : basic_ptr_decl(ptr) {}
       struct_ptr(const basic_ptr_decl &ptr) : basic_ptr_decl(ptr) {}
-      struct_ptr(struct_ptr<T,Allocator> &other) : basic_ptr_decl(static_cast<basic_ptr_decl &>(other)) {}
-      struct_ptr(const struct_ptr<T,Allocator> &other) : basic_ptr_decl(static_cast<const basic_ptr_decl &>(other)) {}
-      struct_ptr(struct_ptr<T,Allocator> &&other) : basic_ptr_decl(static_cast<basic_ptr_decl &&>(other)) {}
+      struct_ptr(struct_ptr<T,Allocator,CheckPolicy> &other) : basic_ptr_decl(static_cast<basic_ptr_decl &>(other)) {}
+      struct_ptr(const struct_ptr<T,Allocator,CheckPolicy> &other) : basic_ptr_decl(static_cast<const basic_ptr_decl &>(other)) {}
+      struct_ptr(struct_ptr<T,Allocator,CheckPolicy> &&other) : basic_ptr_decl(static_cast<basic_ptr_decl &&>(other)) {}
       ~struct_ptr() {}
 
-      struct_ptr<T,Allocator> &operator=(struct_ptr<T,Allocator> &other) {
+      struct_ptr<T,Allocator,CheckPolicy> &operator=(struct_ptr<T,Allocator,CheckPolicy> &other) {
          basic_ptr_decl::operator=(static_cast<basic_ptr_decl &>(other));
 
          return *this;
       }
-      struct_ptr<T,Allocator> &operator=(const struct_ptr<T,Allocator> &other) {
+      struct_ptr<T,Allocator,CheckPolicy> &operator=(const struct_ptr<T,Allocator,CheckPolicy> &other) {
          basic_ptr_decl::operator=(static_cast<const basic_ptr_decl &>(other));
 
          return *this;
       }
-      struct_ptr<T,Allocator> &operator=(struct_ptr<T,Allocator> &&other) {
+      struct_ptr<T,Allocator,CheckPolicy> &operator=(struct_ptr<T,Allocator,CheckPolicy> &&other) {
          basic_ptr_decl::operator=(static_cast<basic_ptr_decl &&>(other));
 
          return *this;
@@ -73,18 +81,23 @@ namespace ptrtools
       using basic_ptr_decl::index;
       using basic_ptr_decl::at;
       using basic_ptr_decl::assign;
+      using basic_ptr_decl::view;
+      using basic_ptr_decl::slice;
       using basic_ptr_decl::clone;
       using basic_ptr_decl::copy;
 
    public:
+      view_type view() { return view_type(basic_ptr_decl::view()); }
+      const_view_type view() const { return const_view_type(basic_ptr_decl::view()); }
+
       void clone(const_pointer ptr, std::size_t size=basic_ptr_decl::type_size) {
          basic_ptr_decl::clone(ptr, size);
       }
       void clone(const basic_ptr_decl &other) {
          basic_ptr_decl::clone(other.get(), other.size());
       }
-      void clone(const struct_ptr<T,Allocator> &other) {
-         struct_ptr<T,Allocator>::clone(other.get(), other.size());
+      void clone(const struct_ptr<T,Allocator,CheckPolicy> &other) {
+         struct_ptr<T,Allocator,CheckPolicy>::clone(other.get(), other.size());
       }
       void copy(const_pointer ptr, std::size_t size=basic_ptr_decl::type_size) {
          basic_ptr_decl::copy(ptr, size, 0, true);
@@ -92,8 +105,8 @@ namespace ptrtools
       void copy(const basic_ptr_decl &other) {
          basic_ptr_decl::copy(other.get(), other.size());
       }
-      void copy(const struct_ptr<T,Allocator> &other) {
-         struct_ptr<T,Allocator>::copy(other.get(), other.size());
+      void copy(const struct_ptr<T,Allocator,CheckPolicy> &other) {
+         struct_ptr<T,Allocator,CheckPolicy>::copy(other.get(), other.size());
       }
    };
 }
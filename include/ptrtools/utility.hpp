@@ -4,11 +4,12 @@
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <stdexcept>
 
 namespace ptrtools
 {
    template <typename T>
-   T align(T value, T boundary) {
+   constexpr T align(T value, T boundary) {
       if (boundary == 0)
          throw std::runtime_error("divide by zero");
 
@@ -0,0 +1,193 @@
+#ifndef __PTRTOOLS_VIEW_HPP
+#define __PTRTOOLS_VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <ptrtools/handle.hpp>
+#include <ptrtools/iterator.hpp>
+#include <ptrtools/policy.hpp>
+#include <ptrtools/utility.hpp>
+
+namespace ptrtools
+{
+   // Views are the non-owning counterparts of basic_ptr, array_ptr and struct_ptr: a pointer and a
+   // byte size, trivially copyable, with the same element API. Like std::span, the constness of a
+   // view is part of T (basic_view<const T>) rather than of the view object itself.
+   template <
+      typename T,
+      std::size_t TypeSize=sizeof(T),
+      std::size_t TypeAlign=alignof(T),
+      typename CheckPolicy=default_policy>
+   class basic_view
+   {
+      static_assert(!std::is_void<T>::value, "Type cannot be void");
+
+   public:
+      using value_type = T;
+      using pointer = value_type *;
+      using const_pointer = const value_type *;
+      using reference = value_type &;
+      using const_reference = const value_type &;
+      using check_policy = CheckPolicy;
+
+      const static std::size_t type_size = TypeSize;
+      const static std::size_t type_align = TypeAlign;
+      const static std::size_t type_stride = align(TypeSize, TypeAlign);
+
+      using iterator = basic_iterator<T,type_stride,CheckPolicy,false>;
+      using const_iterator = basic_iterator<const T,type_stride,CheckPolicy,false>;
+      using reverse_iterator = basic_iterator<T,type_stride,CheckPolicy,true>;
+      using const_reverse_iterator = basic_iterator<const T,type_stride,CheckPolicy,true>;
+
+   protected:
+      pointer _ptr = nullptr;
+      std::size_t _size = 0;
+
+      template <std::size_t LocalTypeSize, std::size_t LocalTypeAlign>
+      std::uintptr_t address_at(std::size_t offset, bool aligned) const {
+         CheckPolicy::check(this->_ptr != nullptr, "null pointer: attempting to access a null pointer");
+         CheckPolicy::check(!aligned || offset % this->type_align == 0, "alignment error: the given offset is not aligned to the type boundary");
+         CheckPolicy::check(offset + align(LocalTypeSize, LocalTypeAlign) <= this->_size, "out of bounds: the given offset exceeds the view boundary");
+
+         return reinterpret_cast<std::uintptr_t>(this->_ptr) + offset;
+      }
+      pointer end_element() const {
+         if (this->_ptr == nullptr)
+            return this->_ptr;
+
+         return reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(this->_ptr) + this->elements() * this->type_stride);
+      }
+      pointer last_element() const {
+         if (this->_ptr == nullptr)
+            return this->_ptr;
+
+         return reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(this->end_element()) - this->type_stride);
+      }
+
+   public:
+      basic_view() = default;
+      basic_view(pointer ptr, std::size_t size=TypeSize) : _ptr(ptr), _size(size) {}
+      template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value && !std::is_const<U>::value>::type>
+      basic_view(const basic_view<U,TypeSize,TypeAlign,CheckPolicy> &other) : _ptr(other.get()), _size(other.size()) {}
+
+      bool operator==(const basic_view<T,TypeSize,TypeAlign,CheckPolicy> &other) const { return this->_ptr == other._ptr && this->_size == other._size; }
+      bool operator!=(const basic_view<T,TypeSize,TypeAlign,CheckPolicy> &other) const { return !(*this == other); }
+      reference operator[](std::size_t pos) const { return this->at(pos); }
+      reference operator*() const {
+         CheckPolicy::check(this->_ptr != nullptr, "null pointer: attempting to dereference a null pointer");
+
+         return *this->_ptr;
+      }
+      pointer operator->() const { return &**this; }
+
+      bool is_const() const { return std::is_const<T>::value; }
+      bool is_null() const { return this->_ptr == nullptr; }
+
+      pointer get() const { return this->_ptr; }
+      pointer eob() const {
+         if (this->_ptr == nullptr)
+            return this->_ptr;
+
+         return reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(this->_ptr) + this->_size);
+      }
+      pointer reob() const {
+         if (this->_ptr == nullptr)
+            return this->_ptr;
+
+         return reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(this->_ptr) - this->type_stride);
+      }
+
+      std::size_t size() const { return this->_size; }
+      std::size_t aligned_type_size() const { return this->type_stride; }
+      std::size_t elements() const { return this->_size / this->type_stride; }
+      reference front() const { return (*this)[0]; }
+      reference back() const { return (*this)[this->elements()-1]; }
+
+      iterator begin() const { return iterator(this->_ptr); }
+      const_iterator cbegin() const { return const_iterator(this->_ptr); }
+      reverse_iterator rbegin() const { return reverse_iterator(this->last_element()); }
+      const_reverse_iterator crbegin() const { return const_reverse_iterator(this->last_element()); }
+      iterator end() const { return iterator(this->end_element()); }
+      const_iterator cend() const { return const_iterator(this->end_element()); }
+      reverse_iterator rend() const { return reverse_iterator(this->reob()); }
+      const_reverse_iterator crend() const { return const_reverse_iterator(this->reob()); }
+
+      std::size_t offset(std::size_t index) const {
+         auto aligned_offset = this->type_stride * index;
+
+         CheckPolicy::check(aligned_offset < this->_size, "out of bounds: the given index goes out of bounds of the aligned view");
+
+         return aligned_offset;
+      }
+      std::size_t index(std::size_t offset) const {
+         CheckPolicy::check(offset < this->_size, "out of bounds: the given offset goes out of bounds of the view");
+
+         return offset / this->type_stride;
+      }
+
+      reference at(std::size_t index) const {
+         return *reinterpret_cast<pointer>(this->template address_at<TypeSize,TypeAlign>(this->offset(index), true));
+      }
+      template <typename U=T, std::size_t LocalTypeSize=sizeof(U), std::size_t LocalTypeAlign=alignof(U)>
+      element_handle<typename std::conditional<std::is_const<T>::value, const U, U>::type,CheckPolicy> handle_at(std::size_t offset, bool aligned=true) const {
+         using local_type = typename std::conditional<std::is_const<T>::value, const U, U>::type;
+
+         return element_handle<local_type,CheckPolicy>(reinterpret_cast<local_type *>(this->template address_at<LocalTypeSize,LocalTypeAlign>(offset, aligned)));
+      }
+      template <typename U=T, std::size_t LocalTypeSize=sizeof(U), std::size_t LocalTypeAlign=alignof(U)>
+      basic_view<typename std::conditional<std::is_const<T>::value, const U, U>::type,LocalTypeSize,LocalTypeAlign,CheckPolicy> view_at(std::size_t offset, bool aligned=true) const {
+         using local_type = typename std::conditional<std::is_const<T>::value, const U, U>::type;
+         auto address = this->template address_at<LocalTypeSize,LocalTypeAlign>(offset, aligned);
+
+         return basic_view<local_type,LocalTypeSize,LocalTypeAlign,CheckPolicy>(reinterpret_cast<local_type *>(address), align(LocalTypeSize, LocalTypeAlign));
+      }
+      basic_view<T,TypeSize,TypeAlign,CheckPolicy> slice(std::size_t offset, std::size_t size) const {
+         CheckPolicy::check(this->_ptr != nullptr || size == 0, "null pointer: attempting to slice a null pointer");
+         CheckPolicy::check(offset <= this->_size && size <= this->_size - offset, "out of bounds: the slice exceeds the view boundary");
+
+         return basic_view<T,TypeSize,TypeAlign,CheckPolicy>(reinterpret_cast<pointer>(reinterpret_cast<std::uintptr_t>(this->_ptr) + offset), size);
+      }
+   };
+
+   template <typename T, typename CheckPolicy=default_policy>
+   class array_view : public basic_view<T,sizeof(T),alignof(T),CheckPolicy>
+   {
+   public:
+      using basic_view_decl = basic_view<T,sizeof(T),alignof(T),CheckPolicy>;
+      using value_type = typename basic_view_decl::value_type;
+      using pointer = typename basic_view_decl::pointer;
+      using reference = typename basic_view_decl::reference;
+      using check_policy = CheckPolicy;
+
+      array_view() = default;
+      array_view(pointer ptr, std::size_t elements) : basic_view_decl(ptr, elements * basic_view_decl::type_stride) {}
+      array_view(const basic_view_decl &view) : basic_view_decl(view) {}
+      template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value && !std::is_const<U>::value>::type>
+      array_view(const array_view<U,CheckPolicy> &other) : basic_view_decl(other.get(), other.size()) {}
+
+      array_view<T,CheckPolicy> slice(std::size_t index, std::size_t elements) const {
+         return array_view<T,CheckPolicy>(basic_view_decl::slice(index * this->type_stride, elements * this->type_stride));
+      }
+   };
+
+   template <typename T, typename CheckPolicy=default_policy>
+   class struct_view : public basic_view<T,sizeof(T),alignof(T),CheckPolicy>
+   {
+   public:
+      using basic_view_decl = basic_view<T,sizeof(T),alignof(T),CheckPolicy>;
+      using value_type = typename basic_view_decl::value_type;
+      using pointer = typename basic_view_decl::pointer;
+      using reference = typename basic_view_decl::reference;
+      using check_policy = CheckPolicy;
+
+      struct_view() = default;
+      struct_view(pointer ptr, std::size_t size=sizeof(T)) : basic_view_decl(ptr, size) {}
+      struct_view(const basic_view_decl &view) : basic_view_decl(view) {}
+      template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value && !std::is_const<U>::value>::type>
+      struct_view(const struct_view<U,CheckPolicy> &other) : basic_view_decl(other.get(), other.size()) {}
+   };
+}
+
+#endif
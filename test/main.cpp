@@ -1,3 +1,11 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include <framework.hpp>
 #include <ptrtools.hpp>
 
@@ -10,6 +18,30 @@ struct test_struct_basic
    std::uint32_t u32;
 };
 
+struct test_struct_big_endian
+{
+   std::uint8_t u8;
+   be<std::uint16_t> u16;
+   be<std::uint32_t> u32;
+   le<std::uint32_t> le32;
+   be<float> f32;
+};
+
+struct test_record
+{
+   std::uint64_t id;
+   double price;
+   std::uint32_t quantity;
+   std::uint8_t padding[44];
+};
+
+struct test_message
+{
+   std::uint16_t type;
+   std::uint16_t length;
+   std::uint32_t values[1];
+};
+
 struct test_struct_flexible
 {
    std::uint8_t u8;
@@ -51,6 +83,11 @@ int test_basic()
    ASSERT(&slice_u8[0xC] == &cloned_u8[0xC])
    ASSERT(slice_u8[0xC] == 0xDE);
    ASSERT_THROWS(slice_u8.ptr_at(16), std::runtime_error);
+   ASSERT(slice_u8.handle_at(4).get() == &cloned_u8[4]);
+   ASSERT(*slice_u8.handle_at<std::uint32_t>(4) == *cloned_u8.ptr_at<std::uint32_t>(4));
+   ASSERT(std::is_trivially_copyable<decltype(slice_u8.handle_at(0))>::value);
+   ASSERT_THROWS(slice_u8.handle_at<std::uint32_t>(14), std::runtime_error);
+   ASSERT_THROWS(slice_u8.at(16), std::runtime_error);
 
    const basic_ptr<std::uint32_t> slice_u32(reinterpret_cast<const std::uint32_t *>(cloned_u8.get()), cloned_u8.size());
    ASSERT(slice_u32[0] == 0xEFBEADDE);
@@ -218,26 +255,1871 @@ int test_flexible()
       }
    }
 
+   ASSERT(flex_ptr.flexible_data() == flex_ptr->flex);
+   ASSERT_THROWS(flex_ptr[4], std::runtime_error);
+
+   auto flexible = flex_ptr.flexible_array();
+   ASSERT(flexible.get() == flex_ptr.flexible_data());
+   ASSERT(flexible.elements() == 4);
+   ASSERT(flexible[2] == 0xDEFACED1B00B7355);
+
+   using category = std::iterator_traits<decltype(flex_ptr)::iterator>::iterator_category;
+   ASSERT((std::is_same<category, std::random_access_iterator_tag>::value));
+   ASSERT(flex_ptr.end() - flex_ptr.begin() == 4);
+   ASSERT(*flex_ptr.rbegin() == 0x8675309);
+   ASSERT(std::find(flex_ptr.begin(), flex_ptr.end(), 0xFACEBABEABAD1DEA) - flex_ptr.begin() == 1);
+
+   std::uint64_t reversed[4];
+   ASSERT_SUCCESS(std::copy(flex_ptr.rbegin(), flex_ptr.rend(), reversed));
+   ASSERT(reversed[0] == 0x8675309 && reversed[3] == 0xC01DC0FFEE);
+
+   const auto &const_flex = flex_ptr;
+   std::size_t visited = 0;
+
+   for (auto &entry : const_flex)
+      visited += &entry == &const_flex[visited];
+
+   ASSERT(visited == 4);
+
+   flexible_ptr<test_struct_flexible,std::uint64_t> empty_flex;
+   ASSERT(empty_flex.elements() == 0);
+   ASSERT(empty_flex.begin() == empty_flex.end());
+   ASSERT(empty_flex.flexible_array().elements() == 0);
+   ASSERT_THROWS(empty_flex[0], std::runtime_error);
+
    COMPLETE();
 }
 
-int
-main
-(int argc, char *argv[])
+int test_policy()
 {
    INIT();
 
-   LOG_INFO("Testing basic_ptr objects.");
-   PROCESS_RESULT(test_basic);
+   auto data = "\xde\xad\xbe\xef\xab\xad\x1d\xea\xde\xad\xbe\xa7\xde\xfa\xce\xd1";
+   auto data_u8 = reinterpret_cast<const std::uint8_t *>(data);
+   const basic_ptr<std::uint8_t> checked_u8(data_u8, std::strlen(data));
+   const basic_ptr<std::uint8_t,1,1,std::allocator<std::uint8_t>,unchecked_policy> unchecked_u8(data_u8, std::strlen(data));
+   basic_ptr<std::uint8_t> mutable_checked_u8(data_u8, std::strlen(data));
+   basic_ptr<std::uint8_t,1,1,std::allocator<std::uint8_t>,unchecked_policy> mutable_unchecked_u8(data_u8, std::strlen(data));
 
-   LOG_INFO("Testing struct_ptr objects.");
-   PROCESS_RESULT(test_struct);
+   ASSERT_THROWS(checked_u8.at(16), std::runtime_error);
+   ASSERT_THROWS(checked_u8.offset(16), std::runtime_error);
+   ASSERT_THROWS(checked_u8.ptr_at<std::uint32_t>(14), std::runtime_error);
+   ASSERT_THROWS(mutable_checked_u8.get(), std::runtime_error);
+   ASSERT(unchecked_u8[4] == 0xAB);
+   ASSERT(&unchecked_u8[0xF] == data_u8+0xF);
+   ASSERT(unchecked_u8.offset(16) == 16);
+   ASSERT_SUCCESS(mutable_unchecked_u8.get());
+   ASSERT(mutable_unchecked_u8.get() == data_u8);
 
-   LOG_INFO("Testing array_ptr objects.");
-   PROCESS_RESULT(test_array);
+   array_ptr<std::uint32_t,std::allocator<std::uint8_t>,unchecked_policy> unchecked_u32(4);
+   std::uint32_t sum = 0;
 
-   LOG_INFO("Testing flexible_ptr objects.");
-   PROCESS_RESULT(test_flexible);
+   for (std::size_t i=0; i<unchecked_u32.elements(); ++i)
+      unchecked_u32[i] = static_cast<std::uint32_t>(i+1);
+
+   for (auto value : unchecked_u32)
+      sum += value;
+
+   ASSERT(sum == 10);
+
+   flexible_ptr<test_struct_flexible,std::uint64_t,1,std::allocator<std::uint8_t>,debug_policy> debug_flex(2);
+   ASSERT_SUCCESS(debug_flex[1] = 0x8675309);
+   ASSERT(debug_flex.flexible_array()[1] == 0x8675309);
+
+   COMPLETE();
+}
+
+int test_iterator()
+{
+   INIT();
+
+   std::uint32_t data[] = { 5, 3, 9, 1, 7, 2, 8, 6, 4, 0 };
+   array_ptr<std::uint32_t> array(data, 10);
+
+   using category = std::iterator_traits<array_ptr<std::uint32_t>::iterator>::iterator_category;
+   ASSERT((std::is_base_of<std::random_access_iterator_tag, category>::value));
+   ASSERT(array_ptr<std::uint32_t>::iterator::is_contiguous);
+   ASSERT(!array_ptr<std::uint32_t>::reverse_iterator::is_contiguous);
+   ASSERT(array.end() - array.begin() == 10);
+   ASSERT(array.rend() - array.rbegin() == 10);
+   ASSERT(array.begin()[2] == 9);
+   ASSERT(*(array.begin() + 4) == 7);
+   ASSERT(*(array.end() - 1) == 0);
+   ASSERT(array.begin() < array.end());
+   ASSERT(array.rbegin() < array.rend());
+   ASSERT(*array.rbegin() == 0);
+   ASSERT(array.rbegin()[1] == 4);
+
+   auto iter = array.begin();
+   ASSERT(*iter++ == 5);
+   ASSERT(*iter == 3);
+   ASSERT(*--iter == 5);
+
+   std::sort(array.begin(), array.end());
+   bool sorted = true;
+
+   for (std::uint32_t i=0; i<10; ++i)
+      sorted = sorted && data[i] == i;
+
+   ASSERT(sorted);
+
+   const array_ptr<std::uint32_t> const_array(const_cast<const std::uint32_t *>(data), 10);
+   auto found = std::lower_bound(const_array.cbegin(), const_array.cend(), 6);
+   ASSERT(found != const_array.cend() && *found == 6);
+   ASSERT(found - const_array.cbegin() == 6);
+
+   std::uint32_t reversed[10];
+   std::copy(array.rbegin(), array.rend(), reversed);
+   ASSERT(reversed[0] == 9 && reversed[9] == 0);
+
+   array_ptr<std::uint32_t>::const_iterator converted = array.begin();
+   ASSERT(converted == const_array.cbegin());
+
+   std::uint8_t padded[16] = { 1, 2, 3, 0xFF, 4, 5, 6, 0xFF, 7, 8, 9, 0xFF, 10, 11, 12, 0xFF };
+   basic_ptr<std::uint8_t,3,4> strided(padded, sizeof(padded));
+   ASSERT(strided.elements() == 4);
+   ASSERT(strided.end() - strided.begin() == 4);
+   ASSERT(*(strided.begin() + 2) == 7);
+   ASSERT(*strided.rbegin() == 10);
+
+   array_ptr<std::uint32_t> empty;
+   ASSERT(empty.begin() == empty.end());
+   ASSERT(empty.rbegin() == empty.rend());
+
+   COMPLETE();
+}
+
+int test_view()
+{
+   INIT();
+
+   std::uint32_t data[] = { 0xDEADBEEF, 0xABAD1DEA, 0xDEADBEA7, 0xDEFACED1 };
+   array_ptr<std::uint32_t> cloned(data, 4, true);
+   const array_ptr<std::uint32_t> &const_cloned = cloned;
+
+   ASSERT(std::is_trivially_copyable<array_view<std::uint32_t>>::value);
+   ASSERT(std::is_trivially_copyable<basic_view<std::uint8_t>>::value);
+   ASSERT(sizeof(array_view<std::uint32_t>) == 2*sizeof(void *));
+
+   auto view = cloned.view();
+   ASSERT(view.get() == cloned.get());
+   ASSERT(view.size() == cloned.size());
+   ASSERT(view.elements() == 4);
+   ASSERT(view[1] == 0xABAD1DEA);
+   ASSERT(view.back() == 0xDEFACED1);
+   ASSERT_SUCCESS(view[0] = 0xC01DC0FF);
+   ASSERT(cloned[0] == 0xC01DC0FF);
+   ASSERT(!view.is_const());
+
+   auto const_view = const_cloned.view();
+   ASSERT(const_view.is_const());
+   ASSERT(const_view[2] == 0xDEADBEA7);
+
+   array_view<const std::uint32_t> converted = view;
+   ASSERT(converted == const_view);
+
+   auto slice = cloned.slice(1, 2);
+   ASSERT(slice.elements() == 2);
+   ASSERT(slice.front() == 0xABAD1DEA);
+   ASSERT(slice.back() == 0xDEADBEA7);
+   ASSERT(&slice[0] == &cloned[1]);
+   ASSERT_THROWS(cloned.slice(3, 2), std::runtime_error);
+   ASSERT_THROWS(slice[2], std::runtime_error);
+
+   std::uint32_t sum = 0;
+
+   for (auto value : slice)
+      sum += value;
+
+   ASSERT(sum == 0xABAD1DEA + 0xDEADBEA7);
+
+   basic_ptr<std::uint8_t> bytes(reinterpret_cast<std::uint8_t *>(cloned.get()), cloned.size());
+   auto u16_view = bytes.view_at<std::uint16_t>(4);
+   ASSERT(u16_view.size() == sizeof(std::uint16_t));
+   ASSERT(*u16_view == 0x1DEA);
+   ASSERT_THROWS(bytes.view_at<std::uint32_t>(14), std::runtime_error);
+
+   auto byte_slice = bytes.slice(4, 8);
+   ASSERT(byte_slice.size() == 8);
+   ASSERT(byte_slice[0] == 0xEA);
+
+   struct_ptr<test_struct_basic> structure(true);
+   auto struct_view = structure.view();
+   ASSERT_SUCCESS(struct_view->u16 = 0xBEEF);
+   ASSERT(structure->u16 == 0xBEEF);
+
+   flexible_ptr<test_struct_flexible,std::uint64_t> flex_ptr(4);
+   auto flex_view = flex_ptr.flexible_view();
+   ASSERT(flex_view.elements() == 4);
+   ASSERT_SUCCESS(flex_view[3] = 0x8675309);
+   ASSERT(flex_ptr[3] == 0x8675309);
+
+   COMPLETE();
+}
+
+int test_growth()
+{
+   INIT();
+
+   array_ptr<std::uint32_t> array;
+   bool values_match = true;
+
+   for (std::uint32_t i=0; i<1000; ++i)
+      array.push_back(i);
+
+   for (std::uint32_t i=0; i<1000; ++i)
+      values_match = values_match && array[i] == i;
+
+   ASSERT(array.elements() == 1000);
+   ASSERT(array.size() == 1000*sizeof(std::uint32_t));
+   ASSERT(array.capacity() >= 1000);
+   ASSERT(values_match);
+
+   ASSERT_SUCCESS(array.shrink_to_fit());
+   ASSERT(array.capacity() == 1000);
+   ASSERT(array.back() == 999);
+
+   ASSERT_SUCCESS(array.reserve(4000));
+   ASSERT(array.capacity() == 4000);
+   ASSERT(array.elements() == 1000);
+   ASSERT(array[500] == 500);
+
+   std::uint32_t extra[] = { 0xDEADBEEF, 0xABAD1DEA };
+   ASSERT_SUCCESS(array.append(extra, 2));
+   ASSERT(array.elements() == 1002);
+   ASSERT(array[1001] == 0xABAD1DEA);
+   ASSERT_SUCCESS(array.append(array.get(), 2));
+   ASSERT(array.elements() == 1004);
+   ASSERT(array[1003] == 1);
+   ASSERT(array.emplace_back(0x8675309) == 0x8675309);
+
+   ASSERT_SUCCESS(array.reallocate(10));
+   ASSERT(array.elements() == 10);
+   ASSERT(array.capacity() == 4000);
+   ASSERT_SUCCESS(array.reallocate(12));
+   ASSERT(array[10] == 0 && array[11] == 0);
+
+   std::uint32_t borrowed_data[] = { 1, 2, 3 };
+   array_ptr<std::uint32_t> borrowed(borrowed_data, 3);
+   ASSERT_SUCCESS(borrowed.push_back(4));
+   ASSERT(borrowed.is_allocated());
+   ASSERT(borrowed.get() != borrowed_data);
+   ASSERT(borrowed.elements() == 4);
+   ASSERT(borrowed[0] == 1 && borrowed[3] == 4);
+
+   array_ptr<std::uint32_t> copied(array);
+   ASSERT(copied.elements() == array.elements());
+   ASSERT(copied.capacity() == copied.elements());
+
+   flexible_ptr<test_struct_flexible,std::uint64_t> message(1);
+   ASSERT_SUCCESS(message->u32 = 0xABAD1DEA);
+
+   for (std::uint64_t i=1; i<1000; ++i)
+      message.push_back(i);
+
+   ASSERT(message.elements() == 1000);
+   ASSERT(message.size() == sizeof(test_struct_flexible) + 999*sizeof(std::uint64_t));
+   ASSERT(message.capacity() >= 1000);
+   ASSERT(message->u32 == 0xABAD1DEA);
+   ASSERT(message[999] == 999);
+
+   ASSERT_SUCCESS(message.reserve(5000));
+   ASSERT(message.capacity() == 5000);
+   ASSERT(message.elements() == 1000);
+
+   std::uint64_t entries[] = { 0xDEFACED1B00B7355, 0x8675309 };
+   ASSERT_SUCCESS(message.append(entries, 2));
+   ASSERT_SUCCESS(message.append(message.flexible_array().slice(1, 2)));
+   ASSERT(message.elements() == 1004);
+   ASSERT(message[1001] == 0x8675309);
+   ASSERT(message[1002] == 1 && message[1003] == 2);
+   ASSERT(message.emplace_back(0xC01DC0FFEE) == 0xC01DC0FFEE);
+
+   ASSERT_SUCCESS(message.reallocate(10));
+   ASSERT(message.size() == sizeof(test_struct_flexible) + 9*sizeof(std::uint64_t));
+   ASSERT(message.capacity() == 5000);
+   ASSERT_SUCCESS(message.reallocate(12));
+   ASSERT(message[10] == 0 && message[11] == 0);
+
+   std::size_t reallocations = 0;
+   auto previous = message.flexible_data();
+
+   for (std::size_t i=12; i<20000; ++i)
+   {
+      message.reallocate(i + 1);
+
+      if (message.flexible_data() != previous)
+         ++reallocations;
+
+      previous = message.flexible_data();
+   }
+
+   ASSERT(message.elements() == 20000);
+   ASSERT(reallocations < 10);
+
+   flexible_ptr<test_struct_flexible,std::uint64_t> headerless;
+   ASSERT_THROWS(headerless.push_back(1), std::runtime_error);
+
+   COMPLETE();
+}
+
+int test_allocation_modes()
+{
+   INIT();
+
+   array_ptr<std::uint8_t> uninitialized(64, allocation_mode::uninitialized);
+   ASSERT(uninitialized.is_allocated());
+   ASSERT(uninitialized.elements() == 64);
+
+   const std::size_t large_size = lazy_mapping_threshold * 4;
+   array_ptr<std::uint8_t> lazy(large_size, allocation_mode::lazily_zeroed);
+   bool all_zero = true;
+
+   for (std::size_t i=0; i<large_size; i+=509)
+      all_zero = all_zero && lazy[i] == 0;
+
+   ASSERT(all_zero);
+   ASSERT(lazy.back() == 0);
+
+   ASSERT_SUCCESS(lazy[large_size-1] = 0x69);
+   ASSERT_SUCCESS(lazy.reallocate(large_size-16));
+   ASSERT_SUCCESS(lazy.reallocate(large_size*2, allocation_mode::lazily_zeroed));
+   ASSERT(lazy.elements() == large_size*2);
+   ASSERT(lazy[large_size-1] == 0);
+   ASSERT(lazy[large_size*2-1] == 0);
+   ASSERT(lazy[large_size+509] == 0);
+
+#ifdef __linux__
+   {
+      // growing through array_ptr must leave the freshly mapped pages untouched
+      array_ptr<std::uint8_t> growing(lazy_mapping_threshold, allocation_mode::lazily_zeroed);
+      const std::size_t grown_size = lazy_mapping_threshold * 64;
+      ASSERT_SUCCESS(growing.reallocate(grown_size, allocation_mode::lazily_zeroed));
+
+      auto page = page_size();
+      auto tail = reinterpret_cast<std::uintptr_t>(growing.get() + grown_size - 1) & ~static_cast<std::uintptr_t>(page - 1);
+      unsigned char resident = 1;
+      ASSERT(mincore(reinterpret_cast<void *>(tail), page, &resident) == 0);
+      ASSERT((resident & 1) == 0);
+      ASSERT(growing[grown_size-1] == 0);
+   }
+#endif
+
+   ASSERT_SUCCESS(lazy[0] = 0xDE);
+   array_ptr<std::uint8_t> cloned(lazy);
+   ASSERT(cloned.elements() == lazy.elements());
+   ASSERT(cloned[0] == 0xDE);
+   ASSERT(cloned.get() != lazy.get());
+
+   array_ptr<std::uint8_t> small_lazy(16, allocation_mode::lazily_zeroed);
+   ASSERT(small_lazy[15] == 0);
+
+   flexible_ptr<test_struct_flexible,std::uint64_t> flex_ptr(8, allocation_mode::lazily_zeroed);
+   ASSERT(flex_ptr.elements() == 8);
+   ASSERT(flex_ptr[7] == 0);
+
+   COMPLETE();
+}
+
+template <typename T>
+struct counting_allocator
+{
+   using value_type = T;
+   using propagate_on_container_copy_assignment = std::false_type;
+   using propagate_on_container_move_assignment = std::false_type;
+
+   std::size_t *count;
+
+   counting_allocator(std::size_t *count) : count(count) {}
+   template <typename U>
+   counting_allocator(const counting_allocator<U> &other) : count(other.count) {}
+
+   bool operator==(const counting_allocator<T> &other) const { return this->count == other.count; }
+   bool operator!=(const counting_allocator<T> &other) const { return this->count != other.count; }
+
+   T *allocate(std::size_t n) { ++*this->count; return std::allocator<T>().allocate(n); }
+   void deallocate(T *ptr, std::size_t n) { --*this->count; std::allocator<T>().deallocate(ptr, n); }
+};
+
+// Copies of the same type throw while *fail is set, like a stateful allocator that has to
+// duplicate its state.
+template <typename T>
+struct fragile_allocator
+{
+   using value_type = T;
+
+   bool *fail;
+
+   fragile_allocator(bool *fail) : fail(fail) {}
+   fragile_allocator(const fragile_allocator<T> &other) : fail(other.fail) { if (*this->fail) throw std::bad_alloc(); }
+   template <typename U>
+   fragile_allocator(const fragile_allocator<U> &other) : fail(other.fail) {}
+   fragile_allocator &operator=(const fragile_allocator<T> &other) = default;
+
+   bool operator==(const fragile_allocator<T> &other) const { return this->fail == other.fail; }
+   bool operator!=(const fragile_allocator<T> &other) const { return this->fail != other.fail; }
+
+   T *allocate(std::size_t n) { return std::allocator<T>().allocate(n); }
+   void deallocate(T *ptr, std::size_t n) { std::allocator<T>().deallocate(ptr, n); }
+};
+
+int test_allocators()
+{
+   INIT();
+
+   std::size_t count_a = 0, count_b = 0;
+   counting_allocator<std::uint8_t> alloc_a(&count_a), alloc_b(&count_b);
+
+   array_ptr<std::uint32_t,counting_allocator<std::uint8_t>> counted(8, alloc_a);
+   ASSERT(count_a == 1);
+   ASSERT(counted.get_allocator() == alloc_a);
+   ASSERT_SUCCESS(counted.deallocate());
+   ASSERT(count_a == 0);
+   ASSERT(counted.get_allocator() == alloc_a);
+   ASSERT_SUCCESS(counted.allocate(4));
+   ASSERT(count_a == 1);
+
+   array_ptr<std::uint32_t,counting_allocator<std::uint8_t>> other(4, alloc_b);
+   ASSERT_SUCCESS(counted[3] = 0xFACEBABE);
+   ASSERT_SUCCESS(other = std::move(counted));
+   ASSERT(other.get_allocator() == alloc_b);
+   ASSERT(other[3] == 0xFACEBABE);
+   ASSERT(count_a == 0);
+   ASSERT(count_b == 1);
+
+   ASSERT_SUCCESS(other.allocate(16, alloc_a));
+   ASSERT(count_a == 1 && count_b == 0);
+
+   bool fail = false;
+   fragile_allocator<std::uint8_t> fragile(&fail);
+   array_ptr<std::uint32_t,fragile_allocator<std::uint8_t>> kept(4, fragile);
+   ASSERT_SUCCESS(kept[3] = 0x69);
+
+   // a failed reallocation with a new allocator leaves the old buffer and allocator in place
+   fail = true;
+   ASSERT_THROWS(kept.allocate(8, fragile), std::bad_alloc);
+   fail = false;
+   ASSERT(kept.elements() == 4 && kept[3] == 0x69);
+   ASSERT_SUCCESS(kept.allocate(8, fragile));
+   ASSERT(kept.elements() == 8);
+   ASSERT_SUCCESS(kept.deallocate());
+
+   arena region(4096);
+   arena_allocator<> arena_alloc(region);
+
+   {
+      struct_ptr<test_struct_basic,arena_allocator<>> header(arena_alloc, true);
+      array_ptr<std::uint64_t,arena_allocator<>> body(32, arena_alloc);
+
+      ASSERT(region.owns(header.get()));
+      ASSERT(region.owns(body.get()));
+      ASSERT(reinterpret_cast<std::uintptr_t>(body.get()) % alignof(std::max_align_t) == 0);
+      ASSERT(region.used() >= sizeof(test_struct_basic) + 32 * sizeof(std::uint64_t));
+
+      array_ptr<std::uint64_t,arena_allocator<>> copied(body);
+      ASSERT(region.owns(copied.get()));
+
+      array_ptr<std::uint64_t,arena_allocator<>> moved(std::move(body));
+      ASSERT(body.is_null());
+      ASSERT(region.owns(moved.get()));
+   }
+
+   ASSERT_SUCCESS(region.reset());
+   ASSERT(region.used() == 0);
+   ASSERT_THROWS((array_ptr<std::uint8_t,arena_allocator<>>(8192, arena_alloc)), std::bad_alloc);
+
+   {
+      // freeing a block from before the reset must not hand out a live block again
+      auto stale_first = new array_ptr<std::uint8_t,arena_allocator<>>(64, arena_alloc);
+      auto stale_second = new array_ptr<std::uint8_t,arena_allocator<>>(64, arena_alloc);
+      ASSERT_SUCCESS(region.reset());
+
+      array_ptr<std::uint8_t,arena_allocator<>> live_first(64, arena_alloc);
+      array_ptr<std::uint8_t,arena_allocator<>> live_second(64, arena_alloc);
+      delete stale_second;
+      delete stale_first;
+
+      array_ptr<std::uint8_t,arena_allocator<>> fresh(64, arena_alloc);
+      ASSERT(fresh.get() != live_first.get());
+      ASSERT(fresh.get() != live_second.get());
+      ASSERT(region.used() >= 3 * 64);
+   }
+
+   ASSERT_SUCCESS(region.reset());
+
+   std::uint8_t pmr_buffer[1024];
+   std::pmr::monotonic_buffer_resource resource(pmr_buffer, sizeof(pmr_buffer), std::pmr::null_memory_resource());
+   pmr::array_ptr<std::uint32_t> pmr_array(16, &resource);
+   ASSERT(pmr_array.get_allocator().resource() == &resource);
+   ASSERT(reinterpret_cast<std::uint8_t *>(pmr_array.get()) >= pmr_buffer && reinterpret_cast<std::uint8_t *>(pmr_array.get()) < pmr_buffer + sizeof(pmr_buffer));
+   ASSERT_SUCCESS(pmr_array.push_back(0x69));
+   ASSERT(pmr_array.elements() == 17);
+
+   pmr::array_ptr<std::uint32_t> pmr_copy(pmr_array);
+   ASSERT(pmr_copy.get_allocator().resource() == std::pmr::get_default_resource());
+   ASSERT(pmr_copy[16] == 0x69);
+
+   COMPLETE();
+}
+
+int test_caching()
+{
+   INIT();
+
+   ASSERT(caching_pool::size_class(1) == 0);
+   ASSERT(caching_pool::size_class(16) == 0);
+   ASSERT(caching_pool::size_class(17) == 1);
+   ASSERT(caching_pool::size_class(caching_pool::max_class_size) == caching_pool::size_classes-1);
+
+   struct_ptr<test_struct_basic,caching_allocator<>> first(true);
+   auto first_block = first.get();
+   ASSERT_SUCCESS(first->u32 = 0xDEADBEEF);
+
+   struct_ptr<test_struct_basic,caching_allocator<>> cloned(first);
+   ASSERT(cloned.get() != first_block);
+   ASSERT(cloned->u32 == 0xDEADBEEF);
+   ASSERT_SUCCESS(first.deallocate());
+
+   struct_ptr<test_struct_basic,caching_allocator<>> reused(true);
+   ASSERT(reused.get() == first_block);
+
+   array_ptr<std::uint32_t,caching_allocator<>> grown(4);
+   for (std::uint32_t i=0; i<20000; ++i)
+      grown.push_back(i);
+
+   ASSERT(grown.elements() == 20004);
+   ASSERT(grown[20003] == 19999);
+
+   std::vector<std::thread> threads;
+   std::atomic<std::size_t> failures(0);
+
+   for (std::size_t t=0; t<4; ++t)
+      threads.emplace_back([&failures, t]() {
+         std::vector<flexible_ptr<test_struct_flexible,std::uint64_t,1,caching_allocator<>>> live;
+
+         for (std::size_t i=0; i<4096; ++i)
+         {
+            live.emplace_back(1 + i % 8);
+            live.back()[0] = t;
+
+            if (i % 3 == 0)
+               live.erase(live.begin());
+         }
+
+         for (auto &ptr : live)
+            if (ptr[0] != t)
+               ++failures;
+      });
+
+   for (auto &thread : threads)
+      thread.join();
+
+   ASSERT(failures == 0);
+
+   COMPLETE();
+}
+
+template <typename T>
+using shared_array = array_ptr<T,std::allocator<std::uint8_t>,copy_on_write_policy<>>;
+
+int test_shared()
+{
+   INIT();
+
+   static_assert(!array_ptr<std::uint32_t>::copy_on_write, "plain pointers must not pay for sharing");
+
+   shared_array<std::uint32_t> original(1000);
+   for (std::uint32_t i=0; i<1000; ++i)
+      original[i] = i;
+
+   ASSERT(!original.is_shared());
+   ASSERT(original.use_count() == 1);
+   ASSERT_SUCCESS(original.share());
+   ASSERT(original.is_shared());
+   ASSERT(original.use_count() == 1);
+   ASSERT_THROWS(shared_array<std::uint32_t>().share(), std::runtime_error);
+
+   const auto &reader = original;
+   shared_array<std::uint32_t> copy(original);
+   ASSERT(copy.use_count() == 2);
+   ASSERT(std::as_const(copy).get() == reader.get());
+
+   // the first write through a copy moves it onto its own buffer
+   ASSERT_SUCCESS(copy[5] = 0xFACEBABE);
+   ASSERT(std::as_const(copy).get() != reader.get());
+   ASSERT(reader[5] == 5);
+   ASSERT(copy[6] == 6);
+   ASSERT(original.use_count() == 1 && copy.use_count() == 1);
+   ASSERT(copy.is_shared());
+
+   shared_array<std::uint32_t> grown(original);
+   ASSERT_SUCCESS(grown.push_back(1000));
+   ASSERT(grown.elements() == 1001 && reader.elements() == 1000);
+   ASSERT(grown[1000] == 1000 && grown[999] == 999);
+   ASSERT(original.use_count() == 1);
+
+   shared_array<std::uint32_t> resized(original);
+   ASSERT_SUCCESS(resized.resize(10));
+   ASSERT(original.use_count() == 2);
+   ASSERT_SUCCESS(resized.resize(20));
+   ASSERT(original.use_count() == 1);
+   ASSERT(resized[15] == 0 && reader[15] == 15);
+
+   shared_array<std::uint32_t> assigned;
+   ASSERT_SUCCESS(assigned = original);
+   ASSERT_SUCCESS(assigned = original);
+   ASSERT(original.use_count() == 2);
+
+   shared_array<std::uint32_t> moved(std::move(assigned));
+   ASSERT(assigned.is_null());
+   ASSERT(original.use_count() == 2);
+   ASSERT_SUCCESS(moved.deallocate());
+   ASSERT(original.use_count() == 1);
+
+   {
+      shared_array<std::uint32_t> last(original);
+      ASSERT_SUCCESS(original.deallocate());
+      ASSERT(last.use_count() == 1);
+      ASSERT(last[999] == 999);
+   }
+
+   shared_array<std::uint8_t> mapped(4 << 20, allocation_mode::lazily_zeroed);
+   ASSERT_SUCCESS(mapped.share());
+   shared_array<std::uint8_t> mapped_copy(mapped);
+   ASSERT_SUCCESS(mapped_copy[100] = 0x69);
+   ASSERT(std::as_const(mapped)[100] == 0);
+
+   shared_array<std::uint64_t> table(4096);
+   for (std::uint64_t i=0; i<4096; ++i)
+      table[i] = i;
+
+   ASSERT_SUCCESS(table.share());
+
+   std::vector<std::thread> threads;
+   std::atomic<std::size_t> failures(0);
+
+   for (std::size_t t=0; t<4; ++t)
+      threads.emplace_back([&failures, &table, t]() {
+         for (std::size_t round=0; round<64; ++round)
+         {
+            shared_array<std::uint64_t> local(std::as_const(table));
+            std::uint64_t sum = 0;
+
+            for (auto value : std::as_const(local))
+               sum += value;
+
+            if (sum != 4096ull * 4095 / 2)
+               ++failures;
+
+            if ((round + t) % 2 == 0)
+            {
+               local[0] = 42;
+
+               if (std::as_const(table)[0] != 0)
+                  ++failures;
+            }
+         }
+      });
+
+   for (auto &thread : threads)
+      thread.join();
+
+   ASSERT(failures == 0);
+   ASSERT(table.use_count() == 1);
+
+   COMPLETE();
+}
+
+int test_mapped()
+{
+   INIT();
+
+#ifdef PTRTOOLS_HAS_MMAP
+   auto path = (std::filesystem::temp_directory_path() / "ptrtools_mapped_test.bin").string();
+   std::uint64_t contents[] = { 3, 0x1122334455667788ULL, 0xAAAAAAAAAAAAAAAAULL, 0xBBBBBBBBBBBBBBBBULL };
+
+   {
+      std::ofstream output(path, std::ios::binary | std::ios::trunc);
+      output.write(reinterpret_cast<const char *>(contents), sizeof(contents));
+   }
+
+   {
+      mapped_file file(path);
+      ASSERT(file.is_open());
+      ASSERT(file.is_const());
+      ASSERT(file.size() == sizeof(contents));
+      ASSERT_SUCCESS(file.advise(access_pattern::sequential));
+      ASSERT_SUCCESS(file.advise(access_pattern::will_need, 8, 16));
+
+      auto bytes = file.ptr();
+      ASSERT(bytes.is_const());
+      ASSERT(!bytes.is_allocated());
+      ASSERT(bytes.size() == sizeof(contents));
+      ASSERT_THROWS(bytes.get(), std::runtime_error);
+
+      const auto words = file.array<std::uint64_t>();
+      ASSERT(words.elements() == 4);
+      ASSERT(words[1] == 0x1122334455667788ULL);
+
+      const auto flex = file.flexible_at<test_struct_flexible,std::uint64_t>(0, 3);
+      ASSERT(flex->u8 == 3);
+      ASSERT(flex.elements() == 3);
+      ASSERT(flex[2] == 0xBBBBBBBBBBBBBBBBULL);
+
+      ASSERT(file.const_view(8, 8).size() == 8);
+      ASSERT_THROWS(file.view(), std::runtime_error);
+      ASSERT_THROWS(file.ptr(16, 32), std::runtime_error);
+
+      ASSERT(file.array<std::uint32_t>(4, 1).elements() == 1);
+      ASSERT_THROWS(file.array<std::uint32_t>(1), std::runtime_error);
+      ASSERT_THROWS(file.struct_at<test_struct_flexible>(4), std::runtime_error);
+      ASSERT_THROWS((file.flexible_at<test_struct_flexible,std::uint64_t>(4, 1)), std::runtime_error);
+   }
+
+   {
+      mapped_file file(path, map_mode::copy_on_write);
+      auto words = file.array<std::uint64_t>();
+      ASSERT_SUCCESS(words[3] = 0x69);
+      ASSERT(words[3] == 0x69);
+   }
+
+   {
+      mapped_file file(path, map_mode::read_write);
+      auto header = file.struct_at<test_struct_flexible>();
+      ASSERT(header->flex[0] == 0x1122334455667788ULL);
+      ASSERT_SUCCESS(header->u8 = 2);
+      ASSERT_SUCCESS(file.sync());
+
+      mapped_file moved(std::move(file));
+      ASSERT(!file.is_open());
+      ASSERT(moved.is_open());
+   }
+
+   {
+      mapped_file file(path);
+      const auto words = file.array<std::uint64_t>();
+      ASSERT(words[0] == 2);
+      ASSERT(words[3] == 0xBBBBBBBBBBBBBBBBULL);
+   }
+
+   std::filesystem::remove(path);
+   ASSERT_THROWS(mapped_file(path), std::runtime_error);
+#endif
+
+   COMPLETE();
+}
+
+struct alignas(64) test_cache_line
+{
+   std::uint64_t values[8];
+};
+
+template <typename Pointer>
+bool is_aligned_to(const Pointer &ptr, std::size_t boundary)
+{
+   return reinterpret_cast<std::uintptr_t>(ptr.get()) % boundary == 0;
+}
+
+int test_alignment()
+{
+   INIT();
+
+   bool all_aligned = true;
+
+   for (std::size_t i=0; i<32; ++i)
+   {
+      array_ptr<test_cache_line> lines(1 + i);
+      all_aligned = all_aligned && is_aligned_to(lines, 64);
+   }
+
+   ASSERT(all_aligned);
+
+   array_ptr<test_cache_line> grown(1);
+   for (std::size_t i=0; i<100; ++i)
+      grown.push_back(test_cache_line{{i}});
+
+   ASSERT(is_aligned_to(grown, 64));
+   ASSERT(grown[100].values[0] == 99);
+
+   basic_ptr<std::uint8_t,32,32> avx_block(static_cast<std::size_t>(32 * 10));
+   ASSERT(is_aligned_to(avx_block, 32));
+
+   std::size_t count = 0;
+   array_ptr<test_cache_line,counting_allocator<std::uint8_t>> counted(3, counting_allocator<std::uint8_t>(&count));
+   ASSERT(is_aligned_to(counted, 64));
+   ASSERT(count == 1);
+
+   array_ptr<test_cache_line,caching_allocator<>> cached(5);
+   ASSERT(is_aligned_to(cached, 64));
+
+   std::uint8_t pmr_buffer[1024];
+   std::pmr::monotonic_buffer_resource resource(pmr_buffer, sizeof(pmr_buffer), std::pmr::null_memory_resource());
+   pmr::array_ptr<std::uint8_t> unaligned(3, &resource);
+   pmr::array_ptr<std::uint64_t> words(4, &resource);
+   pmr::array_ptr<test_cache_line> pmr_lines(2, &resource);
+   ASSERT(is_aligned_to(words, alignof(std::uint64_t)));
+   ASSERT(is_aligned_to(pmr_lines, 64));
+
+   array_ptr<std::uint32_t,aligned_allocator<std::uint8_t,128>> aligned(7);
+   ASSERT(is_aligned_to(aligned, 128));
+   ASSERT_SUCCESS(aligned.reallocate(4096));
+   ASSERT(is_aligned_to(aligned, 128));
+
+   array_ptr<std::uint8_t,huge_page_allocator<>> small_table(4096);
+   ASSERT(small_table[4095] == 0);
+
+   array_ptr<std::uint8_t,huge_page_allocator<>> huge_table(huge_page_size * 2);
+   ASSERT(is_aligned_to(huge_table, huge_page_size));
+   ASSERT_SUCCESS(huge_table[huge_page_size * 2 - 1] = 0x69);
+
+   array_ptr<std::uint8_t,huge_page_allocator<std::uint8_t,huge_page_mode::hugetlb>> reserved_table(huge_page_size);
+   ASSERT(is_aligned_to(reserved_table, page_size()));
+   ASSERT(reserved_table[huge_page_size - 1] == 0);
+
+   COMPLETE();
+}
+
+template <typename T>
+bool check_simd_kernels(std::size_t elements)
+{
+   array_ptr<T> data(elements);
+   bool passed = true;
+
+   for (std::size_t i=0; i<elements; ++i)
+      data[i] = static_cast<T>((i * 37) % 101) - static_cast<T>(50);
+
+   auto needle = elements > 0 ? data[elements - 1] : static_cast<T>(7);
+   auto expected_find = std::find(data.begin(), data.end(), needle) - data.begin();
+   auto expected_count = static_cast<std::size_t>(std::count(data.begin(), data.end(), needle));
+
+   passed = passed && data.find(needle) == (static_cast<std::size_t>(expected_find) == elements ? array_ptr<T>::npos : static_cast<std::size_t>(expected_find));
+   passed = passed && data.count(needle) == expected_count;
+   passed = passed && data.contains(needle) == (expected_count > 0);
+   passed = passed && !data.contains(static_cast<T>(99));
+
+   if (elements > 0)
+   {
+      passed = passed && data.min() == *std::min_element(data.begin(), data.end());
+      passed = passed && data.max() == *std::max_element(data.begin(), data.end());
+   }
+
+   array_ptr<T> copy(data);
+   passed = passed && data.equal(copy);
+   passed = passed && data.mismatch(copy) == array_ptr<T>::npos;
+
+   if (elements > 0)
+   {
+      copy[elements / 2] = static_cast<T>(copy[elements / 2] + 1);
+      passed = passed && !data.equal(copy);
+      passed = passed && data.mismatch(copy) == elements / 2;
+   }
+
+   data.fill(static_cast<T>(3));
+   passed = passed && data.count(static_cast<T>(3)) == elements;
+
+   return passed;
+}
+
+int test_simd()
+{
+   INIT();
+
+   const simd::level levels[] = { simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512 };
+   const std::size_t sizes[] = { 0, 1, 7, 15, 16, 31, 33, 64, 127, 200, 1031 };
+   auto supported = simd::supported_level();
+
+   for (auto level : levels)
+   {
+      simd::set_level(level);
+      bool passed = true;
+
+      for (auto size : sizes)
+      {
+         passed = passed && check_simd_kernels<std::int8_t>(size);
+         passed = passed && check_simd_kernels<std::uint8_t>(size);
+         passed = passed && check_simd_kernels<std::int16_t>(size);
+         passed = passed && check_simd_kernels<std::uint16_t>(size);
+         passed = passed && check_simd_kernels<std::int32_t>(size);
+         passed = passed && check_simd_kernels<std::uint32_t>(size);
+         passed = passed && check_simd_kernels<std::int64_t>(size);
+         passed = passed && check_simd_kernels<std::uint64_t>(size);
+         passed = passed && check_simd_kernels<float>(size);
+      }
+
+      ASSERT(passed);
+   }
+
+   simd::set_level(supported);
+   ASSERT(simd::active_level() == supported);
+
+   array_ptr<std::uint32_t> values(8);
+   ASSERT(values.find(0, 3) == 3);
+   ASSERT(values.find(0, 8) == array_ptr<std::uint32_t>::npos);
+   ASSERT(values.mismatch(values.slice(0, 4)) == 4);
+
+   array_ptr<std::uint32_t> empty;
+   ASSERT_THROWS(empty.min(), std::runtime_error);
+
+   const std::uint32_t const_data[] = { 1, 2, 3 };
+   array_ptr<std::uint32_t> const_array(const_data, 3);
+   ASSERT_THROWS(const_array.fill(0), std::runtime_error);
+
+   COMPLETE();
+}
+
+int test_search()
+{
+   INIT();
+
+   const simd::level levels[] = { simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512 };
+   auto supported = simd::supported_level();
+
+   // a small alphabet makes near-misses common, which exercises the candidate filters
+   std::string text;
+   std::uint32_t seed = 12345;
+
+   for (std::size_t i=0; i<4099; ++i)
+   {
+      seed = seed * 1103515245 + 12345;
+      text.push_back(static_cast<char>('a' + (seed >> 16) % 4));
+   }
+
+   array_ptr<std::uint8_t> buffer(reinterpret_cast<const std::uint8_t *>(text.data()), text.size());
+   const std::string_view needles[] = { "a", "ab", "abc", "dcba", "abcdabcd", "aaaaaaaaaaaaaaaaaaaa", "e", "cadd" };
+   byte_patterns patterns({ "dcb", "abca", "bbbb", "ca", "dd", "cdcdcd" });
+
+   for (auto level : levels)
+   {
+      simd::set_level(level);
+      bool passed = true;
+
+      for (auto needle : needles)
+      {
+         for (std::size_t start : { std::size_t(0), std::size_t(17), std::size_t(4000), text.size() })
+         {
+            auto expected = text.find(needle, start);
+            passed = passed && buffer.find_bytes(needle, start) == (expected == std::string::npos ? buffer.npos : expected);
+         }
+
+         std::size_t occurrences = 0;
+
+         for (auto offset=text.find(needle); offset != std::string::npos; offset=text.find(needle, offset + needle.size()))
+            ++occurrences;
+
+         passed = passed && buffer.find_all(needle).size() == occurrences;
+      }
+
+      std::size_t start = 0;
+
+      for (auto &match : buffer.find_all(patterns))
+      {
+         for (auto offset=start; offset<match.offset && passed; ++offset)
+            for (std::size_t index=0; index<patterns.size(); ++index)
+               passed = passed && text.compare(offset, patterns.pattern(index).size(), patterns.pattern(index)) != 0;
+
+         for (std::size_t index=0; index<match.pattern; ++index)
+            passed = passed && text.compare(match.offset, patterns.pattern(index).size(), patterns.pattern(index)) != 0;
+
+         passed = passed && text.compare(match.offset, patterns.pattern(match.pattern).size(), patterns.pattern(match.pattern)) == 0;
+         start = match.offset + patterns.pattern(match.pattern).size();
+      }
+
+      ASSERT(passed);
+   }
+
+   simd::set_level(supported);
+
+   const std::uint8_t record_data[] = { 'k', '=', 'v', '\r', '\n', '\r', '\n', 'x', '\r', '\n' };
+   basic_ptr<std::uint8_t> records(record_data, sizeof(record_data));
+   auto lines = records.split_on("\r\n");
+
+   ASSERT(lines.size() == 4);
+   ASSERT(lines[0].size() == 3 && lines[0].get() == record_data);
+   ASSERT(lines[1].size() == 0);
+   ASSERT(lines[2].size() == 1 && lines[2][0] == 'x');
+   ASSERT(lines[3].size() == 0);
+   ASSERT(records.find_any(byte_patterns({ "q", "z" })).offset == records.npos);
+   ASSERT(records.find_any(byte_patterns({ "\n", "\r\n" })).pattern == 1);
+   ASSERT_THROWS(records.find_bytes(""), std::runtime_error);
+   ASSERT_THROWS(byte_patterns({ "a", "" }), std::runtime_error);
+
+   basic_ptr<std::uint8_t> empty;
+   ASSERT(empty.split_on(",").size() == 1);
+   ASSERT(empty.find_bytes("a") == empty.npos);
+
+   COMPLETE();
+}
+
+template <typename T>
+bool check_byteswap(std::size_t size)
+{
+   array_ptr<T> values(size);
+   array_ptr<T> expected(size);
+
+   for (std::size_t i=0; i<size; ++i)
+   {
+      values[i] = static_cast<T>(0x0102030405060708ull * (i + 1));
+      expected[i] = byteswap(values[i]);
+   }
+
+   values.byteswap();
+
+   return values.equal(expected);
+}
+
+int test_endian()
+{
+   INIT();
+
+   ASSERT(byteswap<std::uint16_t>(0x1234) == 0x3412);
+   ASSERT(byteswap<std::uint32_t>(0x12345678) == 0x78563412);
+   ASSERT(byteswap<std::uint64_t>(0x0102030405060708ull) == 0x0807060504030201ull);
+   ASSERT(sizeof(be<std::uint32_t>) == sizeof(std::uint32_t));
+   ASSERT(alignof(be<std::uint64_t>) == alignof(std::uint64_t));
+   ASSERT(sizeof(test_struct_big_endian) == 16);
+
+   const std::uint8_t header_data[] = { 0x69, 0x00, 0xBE, 0xEF, 0xAB, 0xAD, 0x1D, 0xEA, 0xEA, 0x1D, 0xAD, 0xAB, 0x3F, 0xC0, 0x00, 0x00 };
+   const struct_ptr<test_struct_big_endian> header(reinterpret_cast<const test_struct_big_endian *>(header_data), sizeof(header_data));
+
+   ASSERT(header->u8 == 0x69);
+   ASSERT(header->u16 == 0xBEEF);
+   ASSERT(header->u32 == 0xABAD1DEA);
+   ASSERT(header->le32 == 0xABAD1DEA);
+   ASSERT(header->f32 == 1.5f);
+
+   struct_ptr<test_struct_big_endian> written(true);
+   ASSERT_SUCCESS(written->u32 = 0xDEADBEEF);
+   ASSERT(reinterpret_cast<const std::uint8_t *>(written.get())[4] == 0xDE);
+   ASSERT(written->u32.raw() == (byte_order::native == byte_order::big ? 0xDEADBEEF : 0xEFBEADDE));
+
+   const simd::level levels[] = { simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512 };
+   const std::size_t sizes[] = { 0, 1, 3, 8, 15, 16, 17, 33, 64, 100, 1031 };
+   auto supported = simd::supported_level();
+
+   for (auto level : levels)
+   {
+      simd::set_level(level);
+      bool passed = true;
+
+      for (auto size : sizes)
+      {
+         passed = passed && check_byteswap<std::uint16_t>(size);
+         passed = passed && check_byteswap<std::int32_t>(size);
+         passed = passed && check_byteswap<std::uint64_t>(size);
+      }
+
+      ASSERT(passed);
+   }
+
+   simd::set_level(supported);
+
+   array_ptr<std::uint32_t> words(4);
+   words.fill(0x11223344);
+   words.to_native(byte_order::native);
+   ASSERT(words[3] == 0x11223344);
+   words.to_native(byte_order::native == byte_order::big ? byte_order::little : byte_order::big);
+   ASSERT(words[3] == 0x44332211);
+   words.from_native(byte_order::native == byte_order::big ? byte_order::little : byte_order::big);
+   ASSERT(words[0] == 0x11223344);
+
+   const std::uint32_t const_words[] = { 1, 2 };
+   array_ptr<std::uint32_t> const_array(const_words, 2);
+   ASSERT_THROWS(const_array.byteswap(), std::runtime_error);
+
+   COMPLETE();
+}
+
+struct inline_executor
+{
+   std::size_t submitted = 0;
+
+   void submit(std::function<void()> task) {
+      ++this->submitted;
+      task();
+   }
+};
+
+int test_parallel()
+{
+   INIT();
+
+   thread_pool pool(3);
+   array_ptr<std::uint32_t> values(100003);
+   array_ptr<std::uint64_t> squares(100003);
+
+   ASSERT(pool.size() == 3);
+   ASSERT_SUCCESS(parallel::fill(pool, values, 2u, 1000));
+   ASSERT(values.count(2) == values.elements());
+
+   ASSERT_SUCCESS(parallel::for_each(pool, values, [](std::uint32_t &value) { value += 1; }, 1000));
+   ASSERT(values.count(3) == values.elements());
+
+   for (std::size_t i=0; i<values.elements(); ++i)
+      values[i] = static_cast<std::uint32_t>(i);
+
+   ASSERT_SUCCESS(parallel::transform(pool, values, squares, [](std::uint32_t value) { return std::uint64_t(value) * value; }, 1000));
+   ASSERT(squares[100002] == 100002ull * 100002ull);
+   ASSERT(parallel::reduce(pool, squares, std::uint64_t(0), std::plus<std::uint64_t>(), 1000) == 100002ull * 100003ull * 200005ull / 6);
+   ASSERT(parallel::reduce(values, std::uint64_t(0)) == 100002ull * 100003ull / 2);
+
+   array_ptr<std::uint32_t> copied(values.elements());
+   array_ptr<std::uint32_t> short_copy(5000);
+   ASSERT_SUCCESS(parallel::copy(values, copied));
+   ASSERT(copied.equal(values));
+   ASSERT_THROWS(parallel::copy(values, short_copy), std::runtime_error);
+
+   basic_ptr<std::uint16_t,2,8> strided(static_cast<std::size_t>(8 * 1000));
+   ASSERT_SUCCESS(parallel::fill(pool, strided, static_cast<std::uint16_t>(0x6969), 10));
+   ASSERT(strided[999] == 0x6969);
+   ASSERT(parallel::reduce(pool, strided, std::size_t(0), [](std::size_t sum, std::size_t value) { return sum + value; }, 10) == 0x6969 * 1000);
+
+   ASSERT_THROWS(parallel::for_each(pool, values, [](std::uint32_t &value) {
+      if (value == 77777)
+         throw std::runtime_error("test error: thrown from a chunk");
+   }, 1000), std::runtime_error);
+
+   inline_executor executor;
+   ASSERT_SUCCESS(parallel::fill(executor, values, 5u, 1000));
+   ASSERT(executor.submitted > 0);
+   ASSERT(values.count(5) == values.elements());
+
+   // nested parallel calls from inside pool tasks must not deadlock
+   std::atomic<std::size_t> total{0};
+   array_ptr<std::uint32_t> outer(8);
+
+   ASSERT_SUCCESS(parallel::for_each(pool, outer, [&](std::uint32_t &) {
+      array_ptr<std::uint32_t> inner(4096);
+      parallel::fill(pool, inner, 1u, 256);
+      total += parallel::reduce(pool, inner, std::size_t(0), std::plus<std::size_t>(), 256);
+   }, 1));
+   ASSERT(total == 8 * 4096);
+
+   array_ptr<std::uint32_t> empty;
+   ASSERT(parallel::reduce(pool, empty, 7u, std::plus<std::uint32_t>()) == 7);
+
+   COMPLETE();
+}
+
+int test_strided()
+{
+   INIT();
+
+   array_ptr<test_record> records(1001);
+
+   for (std::size_t i=0; i<records.elements(); ++i)
+   {
+      records[i].id = i;
+      records[i].price = static_cast<double>(i) / 2;
+      records[i].quantity = static_cast<std::uint32_t>(i % 10);
+   }
+
+   auto ids = records.field(&test_record::id);
+   auto prices = records.field(&test_record::price);
+   auto quantities = records.field<std::uint32_t>(offsetof(test_record, quantity));
+
+   ASSERT(sizeof(test_record) == 64);
+   ASSERT(ids.stride() == 64);
+   ASSERT(ids.elements() == 1001);
+   ASSERT(ids[1000] == 1000);
+   ASSERT(prices.back() == 500.0);
+   ASSERT(quantities.end() - quantities.begin() == 1001);
+   ASSERT(std::is_sorted(ids.begin(), ids.end()));
+   ASSERT(*std::lower_bound(ids.begin(), ids.end(), 777) == 777);
+   ASSERT(ids.sum() == 1000 * 1001 / 2);
+   ASSERT(prices.sum() == 1000.0 * 1001 / 4);
+   ASSERT(quantities.count(3) == 100);
+   ASSERT(quantities.min() == 0 && quantities.max() == 9);
+   ASSERT(quantities.sum<std::uint64_t>() == quantities.reduce(std::uint64_t(0), std::plus<std::uint64_t>()));
+   ASSERT(ids.slice(10, 5).front() == 10);
+   ASSERT_THROWS(ids.slice(1000, 2), std::runtime_error);
+   ASSERT_THROWS(ids[1001], std::runtime_error);
+   ASSERT_THROWS(records.field<std::uint64_t>(60), std::runtime_error);
+   ASSERT_THROWS(records.field<std::uint32_t>(2), std::runtime_error);
+
+   array_ptr<double> gathered(1001);
+   ASSERT_SUCCESS(prices.gather_to(gathered));
+   ASSERT(gathered[500] == 250.0);
+
+   array_ptr<double> short_gather(10);
+   ASSERT_THROWS(prices.gather_to(short_gather), std::runtime_error);
+
+   gathered.fill(1.0);
+   ASSERT_SUCCESS(prices.scatter_from(gathered));
+   ASSERT(records[123].price == 1.0 && records[123].id == 123);
+
+   ASSERT_SUCCESS(quantities.fill(7));
+   ASSERT(records[999].quantity == 7);
+
+   const auto &const_records = records;
+   strided_view<const std::uint64_t> const_ids = const_records.field(&test_record::id);
+   ASSERT(const_ids.is_const());
+   ASSERT(const_ids[5] == 5);
+
+   array_ptr<test_record> empty;
+   ASSERT(empty.field(&test_record::id).empty());
+   ASSERT_THROWS(empty.field(&test_record::id).min(), std::runtime_error);
+
+   COMPLETE();
+}
+
+int test_soa()
+{
+   INIT();
+
+   array_ptr<test_record> records(1003);
+
+   for (std::size_t i=0; i<records.elements(); ++i)
+   {
+      records[i].id = i;
+      records[i].price = static_cast<double>(i) / 4;
+      records[i].quantity = static_cast<std::uint32_t>(i % 7);
+   }
+
+   using record_table = soa_array<test_record, &test_record::id, &test_record::price, &test_record::quantity>;
+
+   record_table table(records, 100);
+   ASSERT(table.elements() == 1003);
+   ASSERT(table.fields == 3);
+   ASSERT(table[17].get<&test_record::price>() == 17.0 / 4);
+   ASSERT(table[1002]->id == 1002);
+   ASSERT(table.column<&test_record::quantity>().elements() == 1003);
+   ASSERT(simd::count(table.column<&test_record::quantity>().get(), table.elements(), 3u) == 143);
+   ASSERT(simd::max(table.column<&test_record::id>().get(), table.elements()) == 1002);
+   ASSERT_THROWS(table[1003], std::runtime_error);
+
+   test_record loaded = table[500];
+   ASSERT(loaded.id == 500 && loaded.price == 125.0 && loaded.quantity == 500 % 7);
+
+   ASSERT_SUCCESS(table[0].get<&test_record::quantity>() = 99);
+   ASSERT_SUCCESS(table[1] = loaded);
+   ASSERT(table[1]->id == 500);
+   ASSERT_SUCCESS(table[2] = table[3]);
+   ASSERT(table[2]->id == 3);
+
+   auto round_trip = table.to_array(64);
+   ASSERT(round_trip.elements() == 1003);
+   ASSERT(round_trip[0].quantity == 99);
+   ASSERT(round_trip[1].id == 500);
+   ASSERT(round_trip[1002].price == 1002.0 / 4);
+
+   array_ptr<test_record> too_small(10);
+   ASSERT_THROWS(table.gather_to(too_small), std::runtime_error);
+
+   // only the listed fields are stored
+   soa_array<test_record, &test_record::price> prices(records);
+   auto partial = prices.to_array();
+   ASSERT(partial[9].price == 9.0 / 4);
+   ASSERT(partial[9].id == 0);
+
+   soa_array<test_record, &test_record::id, &test_record::quantity> growing;
+   ASSERT(growing.empty());
+
+   for (std::uint64_t i=0; i<100; ++i)
+      growing.push_back(test_record{i, 0.0, static_cast<std::uint32_t>(i * 2), {}});
+
+   ASSERT(growing.elements() == 100);
+   ASSERT(growing.back().get<&test_record::quantity>() == 198);
+
+   const auto &const_growing = growing;
+   ASSERT(const_growing.column<&test_record::id>()[42] == 42);
+
+   ASSERT_SUCCESS(growing.assign(array_ptr<test_record>()));
+   ASSERT(growing.empty());
+
+   arena region(1 << 16);
+   basic_soa_array<test_record,arena_allocator<std::uint8_t>,default_policy,&test_record::id,&test_record::price> arena_table(10, arena_allocator<std::uint8_t>(region));
+   ASSERT(region.used() >= 10 * (sizeof(std::uint64_t) + sizeof(double)));
+
+   COMPLETE();
+}
+
+int test_record_stream()
+{
+   INIT();
+
+   array_ptr<std::uint8_t> buffer;
+   std::size_t total_values = 0;
+
+   // messages of 0 to 4 values, each padded to 8 bytes
+   for (std::uint16_t i=0; i<100; ++i)
+   {
+      std::uint16_t values = i % 5;
+      std::uint16_t length = 4 + values * 4;
+      std::uint8_t bytes[24] = {};
+
+      std::memcpy(bytes, &i, sizeof(i));
+      std::memcpy(bytes + 2, &length, sizeof(length));
+
+      for (std::uint32_t v=0; v<values; ++v)
+      {
+         auto value = static_cast<std::uint32_t>(i * 10 + v);
+         std::memcpy(bytes + 4 + v * 4, &value, sizeof(value));
+      }
+
+      buffer.append(bytes, align<std::size_t>(length, 8));
+      total_values += values;
+   }
+
+   auto message_length = [](const test_message &message) { return static_cast<std::size_t>(message.length); };
+   auto messages = make_record_stream<test_message,std::uint32_t>(buffer, message_length, 8);
+   ASSERT(messages.entry_offset == 4);
+   ASSERT(messages.count() == 100);
+
+   std::size_t seen = 0, values_seen = 0;
+   bool contents_match = true;
+
+   for (auto message : messages)
+   {
+      contents_match = contents_match && message->type == seen && message.elements() == seen % 5;
+
+      for (std::size_t v=0; v<message.elements(); ++v)
+         contents_match = contents_match && message[v] == seen * 10 + v;
+
+      values_seen += message.entries().elements();
+      ++seen;
+   }
+
+   ASSERT(seen == 100);
+   ASSERT(values_seen == total_values);
+   ASSERT(contents_match);
+
+   auto third = std::next(messages.begin(), 3);
+   ASSERT(third.offset() == 8 + 8 + 16);
+   ASSERT(third->header().type == 3);
+   ASSERT(*third->begin() == 30 && third->end() - third->begin() == 3);
+   ASSERT(third->bytes().size() == 16);
+   ASSERT_THROWS((*third)[3], std::runtime_error);
+
+   record_stream<test_message,std::uint32_t> unpadded(buffer.get(), buffer.size(), message_length);
+   ASSERT_THROWS(unpadded.count(), std::runtime_error);
+   ASSERT_THROWS((make_record_stream<test_message,std::uint32_t>(buffer, message_length, 6)), std::runtime_error);
+   ASSERT_THROWS((make_record_stream<test_message,std::uint32_t>(buffer, message_length, 2)), std::runtime_error);
+   ASSERT_THROWS((record_stream<test_message,std::uint32_t>(buffer.get() + 1, buffer.size() - 1, message_length)), std::runtime_error);
+
+   array_ptr<std::uint8_t> truncated(buffer.get(), 36, true);
+   auto truncated_messages = make_record_stream<test_message,std::uint32_t>(truncated, message_length, 8);
+   ASSERT_THROWS(truncated_messages.count(), std::runtime_error);
+
+   // a final header-only record whose trailing entry would run past the buffer
+   alignas(test_message) std::uint8_t short_tail[8 + 4] = {};
+   std::uint16_t first_length = 8, tail_length = 4;
+   std::memcpy(short_tail + 2, &first_length, sizeof(first_length));
+   std::memcpy(short_tail + 8 + 2, &tail_length, sizeof(tail_length));
+   array_ptr<std::uint8_t> short_tail_buffer(short_tail, sizeof(short_tail));
+   auto short_tail_messages = make_record_stream<test_message,std::uint32_t>(short_tail_buffer, message_length);
+   ASSERT(short_tail_messages.begin()->size() == 8);
+   ASSERT_THROWS(short_tail_messages.count(), std::runtime_error);
+
+   auto empty_length = [](const test_message &) { return std::size_t(0); };
+   ASSERT_THROWS((make_record_stream<test_message,std::uint32_t>(buffer, empty_length).count()), std::runtime_error);
+
+   array_ptr<std::uint8_t> nothing;
+   ASSERT((make_record_stream<test_message,std::uint32_t>(nothing, message_length).count() == 0));
+
+   COMPLETE();
+}
+
+int test_cursor()
+{
+   INIT();
+
+   array_ptr<std::uint8_t> buffer(64);
+   byte_cursor writer(buffer);
+
+   writer.write<std::uint8_t>(0x7F);
+   writer.write<std::uint32_t>(0xDEADBEEF);
+   writer.write(be<std::uint16_t>(0x1234));
+   writer.write_varint<std::uint32_t>(300);
+   writer.write_signed_varint<std::int32_t>(-129);
+   writer.write_prefixed<std::uint16_t>("hello", 5);
+   writer.write_varint_prefixed("world!", 6);
+   ASSERT(writer.position() == 1 + 4 + 2 + 2 + 2 + 2 + 5 + 1 + 6);
+   ASSERT(buffer[5] == 0x12 && buffer[6] == 0x34);
+   ASSERT(buffer[7] == 0xAC && buffer[8] == 0x02);
+   ASSERT(buffer[9] == 0xFF && buffer[10] == 0x7E);
+
+   auto written = writer.position();
+   ASSERT_THROWS(writer.write_prefixed<std::uint8_t>(buffer.get(), 300), std::runtime_error);
+   ASSERT_THROWS(writer.skip(64), std::runtime_error);
+   ASSERT(writer.position() == written);
+
+   const_byte_cursor reader(buffer.get(), written);
+   ASSERT(reader.peek<std::uint8_t>() == 0x7F);
+   ASSERT(reader.read<std::uint8_t>() == 0x7F);
+   ASSERT(reader.read<std::uint32_t>() == 0xDEADBEEF);
+   ASSERT(reader.read<be<std::uint16_t>>() == 0x1234);
+   ASSERT(reader.read_varint<std::uint32_t>() == 300);
+   ASSERT(reader.read_signed_varint<std::int32_t>() == -129);
+
+   auto hello = reader.read_prefixed<std::uint16_t>();
+   ASSERT(hello.size() == 5 && std::memcmp(hello.get(), "hello", 5) == 0);
+
+   auto world = reader.read_varint_prefixed();
+   ASSERT(world.size() == 6 && std::memcmp(world.get(), "world!", 6) == 0);
+   ASSERT(reader.at_end());
+   ASSERT_THROWS(reader.read<std::uint8_t>(), std::runtime_error);
+   ASSERT_THROWS(reader.peek<std::uint8_t>(), std::runtime_error);
+
+   reader.seek(1);
+   auto group = reader.reserve(4 + 2);
+   ASSERT(reader.position() == 7);
+   ASSERT(group.read<std::uint32_t>() == 0xDEADBEEF);
+   ASSERT(group.read<be<std::uint16_t>>() == 0x1234);
+   ASSERT(group.at_end());
+
+   reader.seek(reader.size() - 2);
+   ASSERT_THROWS(reader.reserve(4), std::runtime_error);
+   ASSERT_THROWS(reader.seek(reader.size() + 1), std::runtime_error);
+
+   std::uint64_t values[] = { 0, 1, 127, 128, 16384, 0xFFFFFFFFu, 0xFFFFFFFFFFFFFFFFull };
+   std::int64_t signed_values[] = { 0, -1, 63, -64, 64, -65, INT64_MIN, INT64_MAX };
+   array_ptr<std::uint8_t> varints(256);
+   byte_cursor varint_writer(varints);
+
+   for (auto value : values)
+      varint_writer.write_varint(value);
+
+   for (auto value : signed_values)
+      varint_writer.write_signed_varint(value);
+
+   const_byte_cursor varint_reader(varints.get(), varint_writer.position());
+   bool varints_match = true;
+
+   for (auto value : values)
+      varints_match = varints_match && varint_reader.read_varint() == value;
+
+   for (auto value : signed_values)
+      varints_match = varints_match && varint_reader.read_signed_varint() == value;
+
+   ASSERT(varints_match);
+   ASSERT(varint_reader.at_end());
+
+   std::uint8_t overlong[] = { 0x80, 0x80, 0x80, 0x80, 0x10 };
+   ASSERT_THROWS(const_byte_cursor(overlong, sizeof(overlong)).read_varint<std::uint32_t>(), std::runtime_error);
+   ASSERT(const_byte_cursor(overlong, sizeof(overlong)).read_varint<std::uint64_t>() == 0x100000000ull);
+
+   std::uint8_t signed_overflow[] = { 0xAC, 0x04 };
+   ASSERT_THROWS(const_byte_cursor(signed_overflow, sizeof(signed_overflow)).read_signed_varint<std::int8_t>(), std::runtime_error);
+   ASSERT(const_byte_cursor(signed_overflow, sizeof(signed_overflow)).read_signed_varint<std::int16_t>() == 556);
+
+   std::uint8_t unsigned_max[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+   ASSERT_THROWS(const_byte_cursor(unsigned_max, sizeof(unsigned_max)).read_signed_varint<std::int64_t>(), std::runtime_error);
+
+   std::uint8_t padded_minus_one[] = { 0xFF, 0x7F };
+   ASSERT(const_byte_cursor(padded_minus_one, sizeof(padded_minus_one)).read_signed_varint<std::int8_t>() == -1);
+
+   std::uint8_t unterminated[] = { 0x80, 0x80 };
+   ASSERT_THROWS(const_byte_cursor(unterminated, sizeof(unterminated)).read_varint(), std::runtime_error);
+
+   std::uint8_t short_prefix[] = { 0x10, 0x00, 0x00, 0x00, 'a' };
+   ASSERT_THROWS(const_byte_cursor(short_prefix, sizeof(short_prefix)).read_prefixed(), std::runtime_error);
+
+   COMPLETE();
+}
+
+int test_io()
+{
+   INIT();
+
+#ifdef PTRTOOLS_HAS_MMAP
+   auto path = (std::filesystem::temp_directory_path() / "ptrtools_io_test.bin").string();
+
+   struct_ptr<test_struct_basic> header(true);
+   header->u8 = 0x11;
+   header->u32 = 0x22334455;
+
+   flexible_ptr<test_struct_flexible,std::uint64_t> body(3);
+   body->u8 = 3;
+
+   for (std::size_t i=0; i<3; ++i)
+      body[i] = 0x1000 + i;
+
+   array_ptr<std::uint32_t> payload(100);
+
+   for (std::size_t i=0; i<payload.elements(); ++i)
+      payload[i] = static_cast<std::uint32_t>(i * 3);
+
+   const array_ptr<std::uint32_t> shared_payload = payload;
+   std::uint8_t trailer[] = { 0xAA, 0xBB };
+
+   auto output = io_vector::of(header, body, payload);
+   output.add(shared_payload.view()).add(trailer, sizeof(trailer)).add(array_ptr<std::uint8_t>());
+   ASSERT(output.size() == 5);
+   ASSERT(output.bytes() == header.size() + body.size() + payload.size() * 2 + sizeof(trailer));
+   ASSERT(output.is_readonly());
+   ASSERT_THROWS(output.read(0), std::runtime_error);
+
+   int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+   ASSERT(fd >= 0);
+   ASSERT(output.write(fd) == output.bytes());
+   ASSERT(output.write(fd, output.bytes()) == output.bytes());
+
+   struct_ptr<test_struct_basic> read_header(true);
+   flexible_ptr<test_struct_flexible,std::uint64_t> read_body(3);
+   array_ptr<std::uint32_t> read_payload(200);
+   array_ptr<std::uint8_t> read_trailer(4);
+
+   io_vector input;
+   input.add_target(read_header).add_target(read_body).add_target(read_payload).add_target(read_trailer);
+   ASSERT(!input.is_readonly());
+   ASSERT(input.read(fd, 0) == input.bytes());
+   ASSERT(read_header->u8 == 0x11 && read_header->u32 == 0x22334455);
+   ASSERT(read_body->u8 == 3 && read_body[2] == 0x1002);
+   ASSERT(read_payload[99] == 297 && read_payload[199] == 297);
+   ASSERT(read_trailer[0] == 0xAA && read_trailer[1] == 0xBB);
+
+   ::lseek(fd, static_cast<off_t>(output.bytes()), SEEK_SET);
+   ASSERT(input.read(fd) == output.bytes());
+   ASSERT(input.read(fd) == 0);
+
+   array_ptr<std::uint8_t> readonly_target(static_cast<const std::uint8_t *>(trailer), sizeof(trailer));
+   ASSERT_THROWS(io_vector().add_target(readonly_target), std::runtime_error);
+
+   // more segments than one writev call accepts
+   std::vector<std::uint32_t> words(io_max_segments * 2 + 7);
+   io_vector many(words.size());
+
+   for (std::size_t i=0; i<words.size(); ++i)
+   {
+      words[i] = static_cast<std::uint32_t>(i);
+      many.add(&words[i], sizeof(std::uint32_t));
+   }
+
+   ASSERT(many.write(fd, 0) == words.size() * sizeof(std::uint32_t));
+
+   array_ptr<std::uint32_t> read_words(words.size());
+   ASSERT(io_vector().add_target(read_words).read(fd, 0) == read_words.size());
+   ASSERT(std::equal(words.begin(), words.end(), read_words.begin()));
+
+   ::close(fd);
+   std::filesystem::remove(path);
+
+   // a pipe takes far less than 4 MiB at a time, so the writer has to resume partial writes
+   int pipe_fds[2];
+   ASSERT(::pipe(pipe_fds) == 0);
+
+   array_ptr<std::uint8_t> large(4 * 1024 * 1024);
+
+   for (std::size_t i=0; i<large.size(); ++i)
+      large[i] = static_cast<std::uint8_t>(i * 31);
+
+   array_ptr<std::uint8_t> received(large.size() + 16);
+   std::size_t received_bytes = 0;
+
+   std::thread reader([&]() {
+      received_bytes = io_vector().add_target(received).read(pipe_fds[0]);
+   });
+
+   std::size_t sent = io_vector::of(header, large).write(pipe_fds[1]);
+   ::close(pipe_fds[1]);
+   reader.join();
+   ::close(pipe_fds[0]);
+
+   ASSERT(sent == header.size() + large.size());
+   ASSERT(received_bytes == sent);
+   ASSERT(std::memcmp(received.get() + header.size(), large.get(), large.size()) == 0);
+#endif
+
+   COMPLETE();
+}
+
+int test_chunked()
+{
+   INIT();
+
+#ifdef PTRTOOLS_HAS_MMAP
+   auto path = (std::filesystem::temp_directory_path() / "ptrtools_chunked_test.bin").string();
+   array_ptr<std::uint8_t> contents;
+   std::size_t records = 0;
+
+   // length-prefixed records of 1 to 200 bytes, which straddle the 256-byte chunks
+   for (std::size_t i=0; contents.size() < 10000; ++i, ++records)
+   {
+      std::uint8_t record[256];
+      record[0] = static_cast<std::uint8_t>(i % 200 + 1);
+
+      for (std::size_t j=1; j<=record[0]; ++j)
+         record[j] = static_cast<std::uint8_t>(i);
+
+      contents.append(record, record[0] + 1);
+   }
+
+   {
+      std::ofstream output(path, std::ios::binary | std::ios::trunc);
+      output.write(reinterpret_cast<const char *>(contents.get()), static_cast<std::streamsize>(contents.size()));
+   }
+
+   {
+      chunked_reader reader(path, 256, 3, 256);
+      ASSERT(reader.file_size() == contents.size());
+      ASSERT(reader.buffers() == 3);
+
+      std::size_t parsed = 0, chunks = 0;
+      std::uint64_t expected_offset = 0;
+      bool contents_match = true, offsets_match = true;
+      chunked_reader::chunk chunk;
+
+      for (chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+      {
+         offsets_match = offsets_match && chunk.offset() == expected_offset;
+         contents_match = contents_match && std::memcmp(chunk.data(), contents.get() + chunk.offset(), chunk.size()) == 0;
+
+         std::size_t offset = 0;
+
+         while (offset < chunk.size() && offset + 1 + chunk.data()[offset] <= chunk.size())
+         {
+            contents_match = contents_match && chunk.data()[offset + 1] == static_cast<std::uint8_t>(parsed);
+            offset += 1 + chunk.data()[offset];
+            ++parsed;
+         }
+
+         expected_offset = chunk.offset() + offset;
+         reader.carry(chunk.size() - offset);
+         ++chunks;
+
+         if (chunk.is_last())
+            break;
+      }
+
+      ASSERT(chunk.is_last());
+      ASSERT(chunks == (contents.size() + 255) / 256);
+      ASSERT(offsets_match);
+      ASSERT(contents_match);
+      ASSERT(parsed == records);
+      ASSERT(reader.next().empty());
+      ASSERT_THROWS(reader.carry(1), std::runtime_error);
+   }
+
+   {
+      // stopping early must not leave the reader thread blocked
+      chunked_reader reader(path, 128);
+      auto chunk = reader.next();
+      ASSERT(chunk.size() == 128 && chunk.carried() == 0);
+      ASSERT_THROWS(reader.carry(129), std::runtime_error);
+   }
+
+   {
+      // carried bytes would be lost after the last chunk
+      chunked_reader reader(path, 16384);
+      auto chunk = reader.next();
+      ASSERT(chunk.is_last() && chunk.size() == contents.size());
+      ASSERT_SUCCESS(reader.carry(0));
+      ASSERT_THROWS(reader.carry(1), std::runtime_error);
+   }
+
+   {
+      // a failed read is reported at its own chunk, after the chunks read before it
+      int fd = ::open(path.c_str(), O_RDONLY);
+      ASSERT(fd >= 0);
+
+      {
+         chunked_reader reader(fd, 256, 3, 0);
+         auto first = reader.next();
+         ASSERT(first.size() == 256);
+
+         while (reader.buffered() < 2)
+            std::this_thread::yield();
+
+         // every read from here on hits a directory and fails
+         int directory = ::open(std::filesystem::temp_directory_path().c_str(), O_RDONLY);
+         ASSERT(::dup2(directory, fd) == fd);
+         ::close(directory);
+
+         auto second = reader.next();
+         ASSERT(second.offset() == 256);
+
+         while (reader.buffered() < 2)
+            std::this_thread::yield();
+
+         auto third = reader.next();
+         ASSERT(third.offset() == 512 && third.size() == 256);
+         ASSERT(std::memcmp(third.data(), contents.get() + 512, 256) == 0);
+         ASSERT_THROWS(reader.next(), std::runtime_error);
+         ASSERT(reader.next().empty());
+      }
+
+      ::close(fd);
+   }
+
+   {
+      std::ofstream output(path, std::ios::binary | std::ios::trunc);
+   }
+
+   {
+      chunked_reader reader(path, 128);
+      auto chunk = reader.next();
+      ASSERT(chunk.empty() && chunk.is_last());
+   }
+
+   std::filesystem::remove(path);
+   ASSERT_THROWS(chunked_reader(path), std::runtime_error);
+   ASSERT_THROWS(chunked_reader(path, 128, 1), std::runtime_error);
+#endif
+
+   COMPLETE();
+}
+
+instrument::type_report report_for(const std::vector<instrument::type_report> &reports, const char *type)
+{
+   for (auto &report : reports)
+      if (report.type == type)
+         return report;
+
+   return instrument::type_report();
+}
+
+int test_instrument()
+{
+   INIT();
+
+   if (!instrument::enabled)
+   {
+      ASSERT(instrument::snapshot().empty());
+      COMPLETE();
+   }
+
+   struct instrumented_element
+   {
+      std::uint64_t value;
+   };
+
+   instrument::reset();
+
+   {
+      array_ptr<instrumented_element> first(16);
+      array_ptr<instrumented_element> second(first);
+      second.reallocate(32);
+      second.copy(first.get(), first.elements());
+
+      instrumented_element borrowed[4] = {};
+      array_ptr<instrumented_element> consumed(borrowed, 4);
+      consumed.consume();
+
+      std::thread([&]() {
+         array_ptr<instrumented_element> other_thread(first);
+      }).join();
+
+      auto reports = instrument::snapshot();
+      auto report = report_for(reports, "test_instrument()::instrumented_element");
+      ASSERT(report[instrument::event::allocate].calls == 4);
+      ASSERT(report[instrument::event::deallocate].calls == 1);
+      ASSERT(report[instrument::event::reallocate].calls == 1);
+      ASSERT(report[instrument::event::reallocate].bytes == 16 * sizeof(instrumented_element));
+      ASSERT(report[instrument::event::clone].calls == 3);
+      ASSERT(report[instrument::event::clone].bytes == (16 + 4 + 16) * sizeof(instrumented_element));
+      ASSERT(report[instrument::event::copy].calls == 1);
+      ASSERT(report[instrument::event::consume].calls == 1);
+      ASSERT(report.live_bytes == static_cast<std::int64_t>((16 + 32 + 4) * sizeof(instrumented_element)));
+      ASSERT(report.peak_bytes >= static_cast<std::uint64_t>(report.live_bytes));
+      ASSERT(report.peak_bytes <= (16 + 32 + 4 + 16) * sizeof(instrumented_element));
+
+      // peaks are exact once a thread's live bytes move by the publishing granularity
+      {
+         array_ptr<instrumented_element> large(instrument::peak_granularity / sizeof(instrumented_element));
+      }
+
+      report = report_for(instrument::snapshot(), "test_instrument()::instrumented_element");
+      ASSERT(report.live_bytes == static_cast<std::int64_t>((16 + 32 + 4) * sizeof(instrumented_element)));
+      ASSERT(report.peak_bytes >= static_cast<std::uint64_t>(instrument::peak_granularity));
+   }
+
+   std::size_t flushed = 0;
+   instrument::set_sink([&](const std::vector<instrument::type_report> &reports) {
+      auto report = report_for(reports, "test_instrument()::instrumented_element");
+      flushed = report[instrument::event::deallocate].calls;
+   });
+   instrument::flush();
+   ASSERT(flushed == 5);
+   instrument::set_sink(nullptr);
+
+   instrument::reset();
+   auto report = report_for(instrument::snapshot(), "test_instrument()::instrumented_element");
+   ASSERT(report[instrument::event::allocate].calls == 0);
+   ASSERT(report.live_bytes == 0);
+
+   COMPLETE();
+}
+
+int
+main
+(int argc, char *argv[])
+{
+   INIT();
+
+   LOG_INFO("Testing basic_ptr objects.");
+   PROCESS_RESULT(test_basic);
+
+   LOG_INFO("Testing struct_ptr objects.");
+   PROCESS_RESULT(test_struct);
+
+   LOG_INFO("Testing array_ptr objects.");
+   PROCESS_RESULT(test_array);
+
+   LOG_INFO("Testing flexible_ptr objects.");
+   PROCESS_RESULT(test_flexible);
+
+   LOG_INFO("Testing array growth.");
+   PROCESS_RESULT(test_growth);
+
+   LOG_INFO("Testing allocation modes.");
+   PROCESS_RESULT(test_allocation_modes);
+
+   LOG_INFO("Testing allocators.");
+   PROCESS_RESULT(test_allocators);
+
+   LOG_INFO("Testing caching allocator.");
+   PROCESS_RESULT(test_caching);
+
+   LOG_INFO("Testing shared ownership.");
+   PROCESS_RESULT(test_shared);
+
+   LOG_INFO("Testing mapped files.");
+   PROCESS_RESULT(test_mapped);
+
+   LOG_INFO("Testing alignment.");
+   PROCESS_RESULT(test_alignment);
+
+   LOG_INFO("Testing SIMD kernels.");
+   PROCESS_RESULT(test_simd);
+
+   LOG_INFO("Testing byte pattern search.");
+   PROCESS_RESULT(test_search);
+
+   LOG_INFO("Testing endian conversion.");
+   PROCESS_RESULT(test_endian);
+
+   LOG_INFO("Testing parallel algorithms.");
+   PROCESS_RESULT(test_parallel);
+
+   LOG_INFO("Testing strided views.");
+   PROCESS_RESULT(test_strided);
+
+   LOG_INFO("Testing structures of arrays.");
+   PROCESS_RESULT(test_soa);
+
+   LOG_INFO("Testing record streams.");
+   PROCESS_RESULT(test_record_stream);
+
+   LOG_INFO("Testing byte cursors.");
+   PROCESS_RESULT(test_cursor);
+
+   LOG_INFO("Testing vectored I/O.");
+   PROCESS_RESULT(test_io);
+
+   LOG_INFO("Testing chunked reads.");
+   PROCESS_RESULT(test_chunked);
+
+   LOG_INFO("Testing instrumentation.");
+   PROCESS_RESULT(test_instrument);
+
+   LOG_INFO("Testing iterators.");
+   PROCESS_RESULT(test_iterator);
+
+   LOG_INFO("Testing views.");
+   PROCESS_RESULT(test_view);
+
+   LOG_INFO("Testing check policies.");
+   PROCESS_RESULT(test_policy);
 
    COMPLETE();
 }